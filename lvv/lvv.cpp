@@ -54,19 +54,23 @@
  */
 
 #include "lvv.h"
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <climits>
+#include <concepts>
 #include <fstream>
-#include <future>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <random>
+#include <set>
 #include <sstream>
 #include <string>
-#include <thread>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -105,6 +109,91 @@ namespace db {
 
 } // namespace db
 
+namespace calibration {
+
+    const string CROSSOVER_REL_PATH = "./crossovers.txt";
+
+    /**
+     * @brief where one sequence overtakes another
+     */
+    struct Crossover {
+        /** the sequence that is faster below n */
+        string small;
+        /** the sequence that is faster from n on */
+        string large;
+        size_t n;
+    };
+
+    /**
+     * @brief try to read the crossovers written by #write_crossovers. Each
+     * line is "small large n", and lines starting with # are comments
+     *
+     * @see #CROSSOVER_REL_PATH
+     *
+     * @return optional<vector<Crossover>> the crossovers, or nullopt if the
+     * file could not be opened
+     */
+    optional<vector<Crossover>> read_crossovers()
+    {
+        ifstream file;
+        file.open(CROSSOVER_REL_PATH);
+        if(!file) { return {}; }
+
+        vector<Crossover> crossovers;
+        string line;
+        while(getline(file, line)) {
+            if(line.empty() || line.starts_with("#")) { continue; }
+            istringstream fields{line};
+            Crossover c;
+            if(fields >> c.small >> c.large >> c.n) { crossovers.push_back(c); }
+        }
+        return crossovers;
+    }
+
+    /**
+     * @brief write crossovers in the format #read_crossovers reads
+     *
+     * @param crossovers the crossovers to write
+     * @param output the output stream to write to
+     */
+    void write_crossovers(const vector<Crossover>& crossovers, ostream& output)
+    {
+        output << "# small large n: small is faster below n, large from n on\n";
+        for(const auto& c: crossovers) {
+            output << c.small << " " << c.large << " " << c.n << "\n";
+        }
+    }
+
+    /**
+     * @brief merge newly measured crossovers into ones read earlier
+     *
+     * @param old the crossovers read earlier
+     * @param fresh the crossovers just measured
+     * @param measured the names of the sequences that fresh was measured
+     *        between. A crossover in old between two of them is replaced, or
+     *        dropped if they no longer cross
+     * @return vector<Crossover> the crossovers in old between sequences that
+     *         were not both measured, followed by fresh
+     */
+    vector<Crossover> merge_crossovers(const vector<Crossover>& old,
+                                       const vector<Crossover>& fresh,
+                                       const vector<string>& measured)
+    {
+        auto was_measured = [&measured](const string& name) {
+            return ranges::find(measured, name) != measured.end();
+        };
+        vector<Crossover> merged;
+        for(const auto& c: old) {
+            if(!was_measured(c.small) || !was_measured(c.large)) {
+                merged.push_back(c);
+            }
+        }
+        merged.insert(merged.end(), fresh.begin(), fresh.end());
+        return merged;
+    }
+
+} // namespace calibration
+
 /**
  * @brief fetch a set of integers to use for testing
  *
@@ -119,130 +208,1041 @@ unordered_set<int> fetch_int_set(int min_num_ints)
 /** A set of random integers */
 const unordered_set<int> INT_SET = fetch_int_set(db::NUM_INTS);
 
+/**
+ * @brief how the values to insert are distributed
+ */
+enum class KeyDistribution {
+    /** #INT_SET, uniform over all ints */
+    uniform,
+    /** normal around 0, with a standard deviation of #KEY_SCALE */
+    normal,
+    /** exponential from 0, with a mean of #KEY_SCALE */
+    exponential
+};
+
+/** The spread of the non-uniform key distributions */
+constexpr double KEY_SCALE = 1 << 22;
+
+/**
+ * @brief INTERNAL: generate #db::NUM_INTS distinct values from dist
+ *
+ * @param dist the distribution to draw from, rounded to int
+ * @return vector<int> the values, in the order they were first drawn
+ */
+template<class Dist> vector<int> generate_keys_(Dist dist)
+{
+    // a generator of its own, since the tests may be using gen
+    mt19937 key_gen{random_device{}()};
+    unordered_set<int> seen;
+    vector<int> keys;
+    keys.reserve(db::NUM_INTS);
+    while(keys.size() < db::NUM_INTS) {
+        double key = dist(key_gen);
+        if(key < INT_MIN || key > INT_MAX) { continue; }
+        if(seen.insert(static_cast<int>(key)).second) {
+            keys.push_back(static_cast<int>(key));
+        }
+    }
+    return keys;
+}
+
+/**
+ * @brief the distinct values to draw test values from, generated on first use
+ *
+ * @param keys the distribution of the values
+ * @return const vector<int>& #db::NUM_INTS values in random order
+ */
+const vector<int>& key_pool(KeyDistribution keys)
+{
+    switch(keys) {
+    case KeyDistribution::normal: {
+        static const vector<int> pool
+            = generate_keys_(normal_distribution<>{0, KEY_SCALE});
+        return pool;
+    }
+    case KeyDistribution::exponential: {
+        static const vector<int> pool
+            = generate_keys_(exponential_distribution<>{1 / KEY_SCALE});
+        return pool;
+    }
+    default: {
+        static const vector<int> pool{INT_SET.begin(), INT_SET.end()};
+        return pool;
+    }
+    }
+}
+
+/** How far from the previous edit a clustered edit may land */
+constexpr int CLUSTER_RADIUS = 32;
+
+/**
+ * @brief how the values to insert and the positions to remove are ordered
+ */
+enum class Workload {
+    /** values in #INT_SET order, uniformly random removal positions */
+    uniform,
+    /**
+     * each insert and removal lands within about #CLUSTER_RADIUS positions of
+     * the previous one
+     */
+    clustered
+};
+
+/**
+ * @brief the values to insert and the indices to remove in one test run
+ */
+struct TestScript {
+    /** the values to insert, in order */
+    vector<int> values;
+    /**
+     * removal_indices[i] is the index of the element to remove on the ith
+     * iteration. So for example, given sequence {1, 2, 4, 5} and removal
+     * indices {1, 2, 0, 0}, the sequence would be reduced to {1, 4, 5}, then
+     * {1, 4}, then {4}, then {}.
+     */
+    vector<size_t> removal_indices;
+};
+
+/**
+ * @brief INTERNAL: generate the script for one test run. Not timed
+ *
+ * @param num_vals the number of values to insert and remove
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ * @return TestScript the values to insert and the indices to remove
+ */
+TestScript make_script_(size_t num_vals, Workload workload,
+                        KeyDistribution keys = KeyDistribution::uniform)
+{
+    const vector<int>& pool = key_pool(keys);
+    assert(pool.size() >= num_vals);
+
+    TestScript script;
+    script.values.assign(pool.begin(), pool.begin() + num_vals);
+    script.removal_indices.reserve(num_vals);
+
+    if(workload == Workload::uniform) {
+        for(size_t back = num_vals - 1; back < SIZE_MAX; back--) {
+            script.removal_indices.emplace_back(utils::random_size_t(0, back));
+        }
+    }
+    else {
+        // walk a cursor over the final numerical order, inserting whichever
+        // value not yet inserted is nearest to it
+        vector<int> sorted = script.values;
+        sort(sorted.begin(), sorted.end());
+        set<size_t> remaining;
+        for(size_t i = 0; i < num_vals; ++i) { remaining.insert(i); }
+
+        auto walk = [](size_t cursor, size_t back) {
+            long long next = static_cast<long long>(cursor)
+                             + utils::random_int(-CLUSTER_RADIUS,
+                                                 CLUSTER_RADIUS);
+            return static_cast<size_t>(
+                clamp(next, 0LL, static_cast<long long>(back)));
+        };
+
+        size_t cursor = num_vals == 0 ? 0 : utils::random_size_t(0, num_vals - 1);
+        for(size_t i = 0; i < num_vals; ++i) {
+            auto it = remaining.lower_bound(walk(cursor, num_vals - 1));
+            if(it == remaining.end()) { --it; }
+            cursor = *it;
+            script.values[i] = sorted[cursor];
+            remaining.erase(it);
+        }
+
+        for(size_t back = num_vals - 1; back < SIZE_MAX; back--) {
+            cursor = walk(cursor, back);
+            script.removal_indices.emplace_back(cursor);
+        }
+    }
+
+    // sanity check
+    assert(script.removal_indices.empty()
+           || script.removal_indices.back() == 0);
+    return script;
+}
+
+/**
+ * @brief a type the test functions can call a sequence through: either
+ *        IntegerSequence itself, so that every operation is a virtual call, or
+ *        a final sequence, so that every operation is a direct call that the
+ *        compiler can inline
+ */
+template<class S>
+concept TestableSequence
+    = same_as<S, IntegerSequence>
+      || (derived_from<S, IntegerSequence> && is_final_v<S>);
+
 /**
  * @brief INTERNAL: the timed test function. The caller will be timing this
  * function, so it should not do any blocking behavior
  *
- * @param removal_indices a vector dictating the order in which to remove
- * elements.
- * @details removal_indices[i] is the index of the element to remove on the ith
- *          iteration. So for example, given sequence {1, 2, 4, 5} and removal
- *          indices {1, 2, 0, 0}, the sequence would be reduced to {1, 4, 5},
- *          then {1, 4}, then {4}, then {}.
- *          Note that the size of removal_indices indicates the number of
- *          values that will be inserted and removed.
- */
-void inline test_n_core_(IntegerSequence& seq,
-                         const vector<size_t>& removal_indices)
+ * @tparam S the type to call seq through
+ * @param seq the sequence to test, empty
+ * @param script the values to insert, in order, and then the indices to
+ *        remove, in order
+ */
+template<TestableSequence S>
+void inline test_n_core_(S& seq, const TestScript& script)
 {
-    const size_t num_vals = removal_indices.size();
-    assert(INT_SET.size() >= num_vals);
+    assert(script.values.size() == script.removal_indices.size());
 
-    auto itr = INT_SET.begin();
-    for(size_t i = 0; i < num_vals; i++) { seq.insert_numerical(*itr++); }
-    for(size_t i: removal_indices) { seq.remove(i); }
+    for(int n: script.values) { seq.insert_numerical(n); }
+    for(size_t i: script.removal_indices) { seq.remove(i); }
 }
 
 /**
- * @brief INTERNAL: driver function for #test_n. Runs synchronously
- * (directly returns the result) and asynchronously (sets the result on the
- * supplied promise)
+ * @brief INTERNAL: driver function for #test_n. Times num_runs fresh scripts
+ * on seq, one after another on this thread
  *
+ * @tparam S the type to call seq through
  * @param seq the sequence to test
  * @param num_vals the number of values to insert and remove
- * @param promise the promise to set the result on
  * @param num_runs how many times to run the test
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
  *
  * @return chrono::nanoseconds the average time it took to run the test
  */
-chrono::nanoseconds test_n_(IntegerSequence& seq, size_t num_vals,
-                            promise<chrono::nanoseconds> promise,
-                            size_t num_runs = DEFAULT_RUNS_PER_TEST)
+template<TestableSequence S>
+chrono::nanoseconds test_n_(S& seq, size_t num_vals,
+                            size_t num_runs = DEFAULT_RUNS_PER_TEST,
+                            Workload workload = Workload::uniform,
+                            KeyDistribution keys = KeyDistribution::uniform)
 {
     chrono::nanoseconds avg{0};
     for(size_t i = 0; i < num_runs; ++i) {
         // I don't think reseeding is necessary but prof. wants us to do it
         gen.seed(random_device{}());
 
-        vector<size_t> removal_indices{num_vals};
-        for (size_t back = num_vals - 1; back < SIZE_MAX; back--) {
-            removal_indices.emplace_back(utils::random_size_t(0, back));
-        }
-
-        // sanity check
-        assert(removal_indices.at(removal_indices.size() - 1) == 0);
+        TestScript script = make_script_(num_vals, workload, keys);
+        seq.expect_values(script.values);
 
         auto start = chrono::high_resolution_clock::now();
-        test_n_core_(seq, removal_indices);
+        test_n_core_(seq, script);
         auto end = chrono::high_resolution_clock::now();
 
         avg += chrono::duration_cast<chrono::nanoseconds>(end - start);
     }
 
-    chrono::nanoseconds result = avg / num_runs;
-    promise.set_value(result);
-    return result;
+    return avg / num_runs;
+}
+
+/**
+ * @brief a named IntegerSequence to test
+ * @details the factory is called once per #test_n so that every test starts
+ *          from a fresh, empty sequence
+ */
+using NamedSequence
+    = pair<string, function<unique_ptr<IntegerSequence>()>>;
+
+/**
+ * @brief make a default-constructed S, for use as a #NamedSequence factory
+ *
+ * @tparam S the IntegerSequence to make
+ */
+template<class S> unique_ptr<IntegerSequence> make_sequence()
+{
+    return make_unique<S>();
 }
 
 /**
- * @brief test the performance of a vector and a list for a specific N by
- *        inserting and removing (in random order) num_vals elements
+ * @brief make a #HybridSequence whose threshold is calibrated on this host,
+ *        for use as a #register_sequence factory
+ *
+ * @see hybrid_threshold
+ */
+unique_ptr<HybridSequence> make_hybrid_sequence();
+
+/**
+ * @brief INTERNAL: S, made final if it is not already
  *
+ * @tparam S the IntegerSequence to seal
+ */
+template<class S> class Sealed_ final : public S {
+public:
+    using S::S;
+};
+
+/** S if it is final, otherwise S made final, for #test_n_static */
+template<class S>
+using Sealed = conditional_t<is_final_v<S>, S, Sealed_<S>>;
+
+/**
+ * @brief like #test_n_ on a fresh S, but calling S directly rather than
+ *        through the IntegerSequence vtable
+ *
+ * @tparam S the IntegerSequence to test
+ * @param make the factory to make the S from
+ * @param num_vals the number of values to insert and remove
+ * @param num_runs how many times to run the test
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ * @return chrono::nanoseconds the average time it took to run the test
+ */
+template<class S>
+chrono::nanoseconds
+test_n_static(const function<unique_ptr<Sealed<S>>()>& make, size_t num_vals,
+              size_t num_runs, Workload workload, KeyDistribution keys)
+{
+    auto seq = make();
+    return test_n_(*seq, num_vals, num_runs, workload, keys);
+}
+
+/**
+ * @brief a sequence to time without virtual calls, named as in #SEQUENCES
+ * @details the test takes the number of values, the number of runs, the
+ *          workload and the key distribution, as #test_n_static does
+ */
+using NamedStaticTest
+    = pair<string, function<chrono::nanoseconds(size_t, size_t, Workload,
+                                                 KeyDistribution)>>;
+
+/**
+ * @brief a sequence under test, both as a #NamedSequence and as the
+ *        #NamedStaticTest of the same type, so that the two cannot disagree
+ */
+struct RegisteredSequence {
+    NamedSequence sequence;
+    NamedStaticTest static_test;
+};
+
+/**
+ * @brief register S under name, for #REGISTERED_SEQUENCES
+ *
+ * @tparam S the IntegerSequence to register
+ * @param name the name of the sequence
+ * @param make the factory to make each fresh S from, by default its default
+ *        constructor
+ * @return RegisteredSequence both ways of testing S
+ */
+template<class S>
+RegisteredSequence
+register_sequence(const string& name,
+                  function<unique_ptr<Sealed<S>>()> make
+                  = [] { return make_unique<Sealed<S>>(); })
+{
+    return {{name, [make]() -> unique_ptr<IntegerSequence> { return make(); }},
+            {name, [make](size_t num_vals, size_t num_runs, Workload workload,
+                          KeyDistribution keys) {
+                 return test_n_static<S>(make, num_vals, num_runs, workload,
+                                         keys);
+             }}};
+}
+
+/**
+ * @brief the #HybridSequence threshold for this host
+ *
+ * @see make_hybrid_sequence
+ */
+size_t hybrid_threshold();
+
+/** Every sequence under test, in output column order */
+const vector<RegisteredSequence> REGISTERED_SEQUENCES
+    = {register_sequence<VectorAdaptor<>>("vec"),
+       register_sequence<ListAdaptor<>>("list"),
+       register_sequence<OrderStatisticTreeAdaptor>("ost"),
+       register_sequence<CountedBTreeSequence<>>("bptree"),
+       register_sequence<TieredVectorSequence<>>("tiered"),
+       register_sequence<GapBufferSequence>("gap"),
+       register_sequence<PackedMemoryArraySequence<>>("pma"),
+       register_sequence<DevectorSequence>("devector"),
+       register_sequence<UnrolledListSequence<>>("unrolled"),
+       register_sequence<SkipListSequence>("skiplist"),
+       register_sequence<FenwickSequence>("fenwick"),
+       register_sequence<BitwiseTrieSequence>("trie"),
+       register_sequence<LsmSequence<>>("lsm"),
+       register_sequence<TombstoneVectorSequence<>>("tombstone"),
+       register_sequence<EytzingerVectorSequence<>>("eytzinger"),
+       register_sequence<SimdVectorAdaptor>("simdvec"),
+       register_sequence<InterpolationVectorSequence>("interp"),
+       register_sequence<FingerListSequence>("finger"),
+       register_sequence<IndexListSequence>("indexlist"),
+       register_sequence<NodePoolListAdaptor>("listnodepool"),
+       register_sequence<
+           PmrListAdaptor<std::pmr::monotonic_buffer_resource>>(
+           "listmonotonic"),
+       register_sequence<
+           PmrListAdaptor<std::pmr::unsynchronized_pool_resource>>(
+           "listpmrpool"),
+       register_sequence<ArenaListAdaptor>("listarena"),
+       register_sequence<DefragListSequence<>>("defraglist"),
+       register_sequence<PrefetchListSequence<>>("prefetchlist"),
+       register_sequence<HybridSequence>("hybrid", make_hybrid_sequence),
+       register_sequence<InplaceSequence<>>("inplace")};
+
+/** The sequences under test, in output column order */
+const vector<NamedSequence> SEQUENCES = [] {
+    vector<NamedSequence> seqs;
+    for(const auto& r: REGISTERED_SEQUENCES) { seqs.push_back(r.sequence); }
+    return seqs;
+}();
+
+/** #SEQUENCES with their concrete types, for the dispatch mode */
+const vector<NamedStaticTest> STATIC_SEQUENCES = [] {
+    vector<NamedStaticTest> tests;
+    for(const auto& r: REGISTERED_SEQUENCES) {
+        tests.push_back(r.static_test);
+    }
+    return tests;
+}();
+
+/** Tiered vectors of various block sizes, for the blocksize mode */
+const vector<NamedSequence> TIERED_SEQUENCES
+    = {{"tiered32", make_sequence<TieredVectorSequence<32>>},
+       {"tiered64", make_sequence<TieredVectorSequence<64>>},
+       {"tiered128", make_sequence<TieredVectorSequence<128>>},
+       {"tiered256", make_sequence<TieredVectorSequence<256>>},
+       {"tiered512", make_sequence<TieredVectorSequence<512>>},
+       {"tiered1024", make_sequence<TieredVectorSequence<1024>>},
+       {"tiered2048", make_sequence<TieredVectorSequence<2048>>},
+       {"tiered4096", make_sequence<TieredVectorSequence<4096>>}};
+
+/** Prefetching lists of various prefetch distances, for the prefetch mode */
+const vector<NamedSequence> PREFETCH_SEQUENCES
+    = {{"prefetch0", make_sequence<PrefetchListSequence<0>>},
+       {"prefetch1", make_sequence<PrefetchListSequence<1>>},
+       {"prefetch2", make_sequence<PrefetchListSequence<2>>},
+       {"prefetch4", make_sequence<PrefetchListSequence<4>>},
+       {"prefetch8", make_sequence<PrefetchListSequence<8>>},
+       {"prefetch16", make_sequence<PrefetchListSequence<16>>},
+       {"prefetch32", make_sequence<PrefetchListSequence<32>>}};
+
+/**
+ * Vectors and lists of #Payload elements of various sizes, for the payload
+ * mode
+ */
+const vector<NamedSequence> PAYLOAD_SEQUENCES
+    = {{"vec4", make_sequence<VectorAdaptor<>>},
+       {"list4", make_sequence<ListAdaptor<>>},
+       {"vec16", make_sequence<VectorAdaptor<Payload<16>>>},
+       {"list16", make_sequence<ListAdaptor<Payload<16>>>},
+       {"vec64", make_sequence<VectorAdaptor<Payload<64>>>},
+       {"list64", make_sequence<ListAdaptor<Payload<64>>>},
+       {"vec256", make_sequence<VectorAdaptor<Payload<256>>>},
+       {"list256", make_sequence<ListAdaptor<Payload<256>>>}};
+
+/**
+ * @brief find the sequence called name
+ *
+ * @tparam T what each name is paired with
+ * @param seqs the sequences to search
+ * @param name the name to look for
+ * @return optional<size_t> the index of name in seqs, or nullopt if it is not
+ *         there
+ */
+template<class T>
+optional<size_t> sequence_index(const vector<pair<string, T>>& seqs,
+                                const string& name)
+{
+    for(size_t i = 0; i < seqs.size(); ++i) {
+        if(seqs[i].first == name) { return i; }
+    }
+    return {};
+}
+
+/**
+ * @brief test the performance of each of a set of sequences for a specific N
+ *        by inserting and removing (in random order) num_vals elements
+ * @details the sequences are run one after another on this thread, so that no
+ *          sequence's time includes time spent running, or memory bandwidth
+ *          taken by, any of the others
+ *
+ * @param seqs the sequences to test
  * @param num_vals number of elements to insert and remove
  * @param num_runs how many times to run the test
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
  *
- * @return pair<chrono::nanoseconds, chrono::nanoseconds> the average time it
- *         took to run the test for the vector and the list, respectively
+ * @return vector<chrono::nanoseconds> the average time it took to run the test
+ *         for each sequence, in the same order as seqs
  */
-pair<chrono::nanoseconds, chrono::nanoseconds> test_n(size_t num_vals,
-                                                      size_t num_runs = DEFAULT_RUNS_PER_TEST)
+vector<chrono::nanoseconds>
+test_n(const vector<NamedSequence>& seqs, size_t num_vals,
+       size_t num_runs = DEFAULT_RUNS_PER_TEST,
+       Workload workload = Workload::uniform,
+       KeyDistribution keys = KeyDistribution::uniform)
 {
     assert(INT_SET.size() >= num_vals);
 
-    VectorAdaptor v{};
-    ListAdaptor l{};
+    vector<chrono::nanoseconds> durations;
+    for(const auto& [name, make]: seqs) {
+        durations.push_back(test_n_<IntegerSequence>(*make(), num_vals,
+                                                     num_runs, workload, keys));
+    }
+    return durations;
+}
+
+/**
+ * @brief INTERNAL: bisect with #test_n for the N at which b becomes faster
+ *        than a, given that a is faster at lo and b is faster at hi
+ *
+ * @param a the sequence that is faster at lo
+ * @param b the sequence that is faster at hi
+ * @param lo an N at which a is faster
+ * @param hi an N at which b is faster
+ * @return size_t the smallest N, to within 1/8, at which b is faster
+ */
+size_t bisect_crossover_(const NamedSequence& a, const NamedSequence& b,
+                         size_t lo, size_t hi)
+{
+    while(hi - lo > max<size_t>(1, lo / 8)) {
+        size_t mid = lo + (hi - lo) / 2;
+        auto durations = test_n({a, b}, mid);
+        if(durations[1] < durations[0]) { hi = mid; }
+        else {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+/**
+ * @brief find the N at which b becomes faster than a, by bisecting with
+ *        #test_n. Assumes that a is faster below the crossover and b above it
+ *
+ * @param a the sequence expected to be faster for small N
+ * @param b the sequence expected to be faster for large N
+ * @param lo the smallest N to consider
+ * @param hi the largest N to consider
+ * @return size_t the smallest N, to within 1/8, at which b is faster. lo if b
+ *         is faster at lo, and hi if a is still faster at hi
+ */
+size_t find_crossover(const NamedSequence& a, const NamedSequence& b,
+                      size_t lo, size_t hi)
+{
+    auto b_faster = [&](size_t n) {
+        auto durations = test_n({a, b}, n);
+        return durations[1] < durations[0];
+    };
+    if(b_faster(lo)) { return lo; }
+    if(!b_faster(hi)) { return hi; }
+    return bisect_crossover_(a, b, lo, hi);
+}
+
+/** The smallest N the calibrate mode considers */
+constexpr size_t MIN_CALIBRATE_N = 64;
+/** The fraction of the slower time by which the calibrate mode needs two
+ *  times to differ before it calls one of them faster */
+constexpr double CALIBRATE_NOISE_MARGIN = 0.05;
+/** The number of runs the calibrate mode re-times a pair with when their
+ *  times are within #CALIBRATE_NOISE_MARGIN */
+constexpr size_t CALIBRATE_RETIME_RUNS = 4 * DEFAULT_RUNS_PER_TEST;
+
+/**
+ * @brief INTERNAL: which of two times is faster, if they are further apart
+ *        than #CALIBRATE_NOISE_MARGIN
+ *
+ * @param a the time of the first sequence
+ * @param b the time of the second sequence
+ * @return optional<bool> whether b is faster, or nullopt if it is too close to
+ *         call
+ */
+optional<bool> b_faster_(chrono::nanoseconds a, chrono::nanoseconds b)
+{
+    auto gap = max(a, b) - min(a, b);
+    if(gap.count() <= CALIBRATE_NOISE_MARGIN * max(a, b).count()) {
+        return {};
+    }
+    return b < a;
+}
+
+/**
+ * @brief find where each pair of seqs cross over, between #MIN_CALIBRATE_N and
+ *        max_n. Every sequence is first timed at powers of two, and a pair
+ *        whose times at a power are too close to call is re-timed there with
+ *        #CALIBRATE_RETIME_RUNS runs. The winner at max_n is taken as the
+ *        winner for large N, and the pair is bisected between the two powers
+ *        of its last change of winner, so only pairs that do cross are
+ *        bisected. A pair is skipped if its winner at any power above that
+ *        change is still too close to call
+ *
+ * @param seqs the sequences to calibrate
+ * @param max_n the largest N to consider
+ * @param report the output stream to write a line per crossover to
+ * @return vector<calibration::Crossover> the last crossover of each pair that
+ *         has one
+ */
+vector<calibration::Crossover>
+calibrate(const vector<NamedSequence>& seqs, size_t max_n, ostream& report)
+{
+    vector<size_t> grid;
+    for(size_t n = MIN_CALIBRATE_N; n < max_n; n *= 2) { grid.push_back(n); }
+    grid.push_back(max(max_n, MIN_CALIBRATE_N));
+
+    vector<vector<chrono::nanoseconds>> times;
+    for(size_t n: grid) { times.push_back(test_n(seqs, n)); }
+
+    vector<calibration::Crossover> crossovers;
+    if(grid.size() < 2) { return crossovers; }
+    for(size_t a = 0; a < seqs.size(); ++a) {
+        for(size_t b = a + 1; b < seqs.size(); ++b) {
+            auto winner = [&](size_t g) {
+                if(auto w = b_faster_(times[g][a], times[g][b])) { return w; }
+                auto durations = test_n({seqs[a], seqs[b]}, grid[g],
+                                        CALIBRATE_RETIME_RUNS);
+                return b_faster_(durations[0], durations[1]);
+            };
+            auto large_winner = winner(grid.size() - 1);
+            if(!large_winner) { continue; }
 
-    promise<chrono::nanoseconds> vec_promise;
-    promise<chrono::nanoseconds> list_promise;
+            // walk down from the top until the winner changes
+            size_t g = grid.size() - 1;
+            optional<bool> w;
+            do {
+                --g;
+                w = winner(g);
+            } while(g > 0 && w == large_winner);
+            if(w != !*large_winner) { continue; }
 
-    future<chrono::nanoseconds> vec_future = vec_promise.get_future();
-    future<chrono::nanoseconds> list_future = list_promise.get_future();
+            const auto& small = *large_winner ? seqs[a] : seqs[b];
+            const auto& large = *large_winner ? seqs[b] : seqs[a];
+            size_t n = bisect_crossover_(small, large, grid[g], grid[g + 1]);
+            crossovers.push_back({small.first, large.first, n});
+            report << small.first << " -> " << large.first << " at " << n
+                   << endl;
+        }
+    }
+    return crossovers;
+}
 
-    jthread vec_thread(test_n_, ref(v), num_vals, move(vec_promise), num_runs);
-    jthread list_thread(test_n_, ref(l), num_vals, move(list_promise), num_runs);
+/**
+ * @brief the size at which a #HybridSequence should stop being a vector: the
+ *        crossover between "vec" and "tiered" on this host. Read from the
+ *        #calibration::CROSSOVER_REL_PATH written by the calibrate mode if it
+ *        has it, and otherwise measured with #find_crossover the first time it
+ *        is needed, over the range the calibrate mode covers by default:
+ *        from #MIN_CALIBRATE_N to #DEFAULT_NUM_TESTS
+ *
+ * @return size_t the threshold
+ */
+size_t hybrid_threshold()
+{
+    static const size_t threshold = [] {
+        for(const auto& c:
+            calibration::read_crossovers().value_or(
+                vector<calibration::Crossover>{})) {
+            if(c.small == "vec" && c.large == "tiered") { return c.n; }
+        }
 
-    chrono::nanoseconds vec_duration = vec_future.get();
-    chrono::nanoseconds list_duration = list_future.get();
+        auto vec = sequence_index(SEQUENCES, "vec");
+        auto tiered = sequence_index(SEQUENCES, "tiered");
+        assert(vec && tiered);
+        size_t crossover = find_crossover(SEQUENCES[*vec], SEQUENCES[*tiered],
+                                          MIN_CALIBRATE_N, DEFAULT_NUM_TESTS);
+        cerr << "hybrid threshold: " << crossover << endl;
+        return crossover;
+    }();
+    return threshold;
+}
 
-    return make_pair(vec_duration, list_duration);
+unique_ptr<HybridSequence> make_hybrid_sequence()
+{
+    return make_unique<HybridSequence>(hybrid_threshold());
+}
+
+/**
+ * @brief write the csv header matching the rows written by #test_block
+ *
+ * @param seqs the sequences that will be tested
+ * @param output the output stream to write to
+ * @param extra_columns names of any columns that follow the times
+ */
+void write_header(const vector<NamedSequence>& seqs, ostream& output,
+                  const vector<string>& extra_columns = {})
+{
+    output << "x";
+    for(const auto& [name, make]: seqs) { output << "," << name << "time"; }
+    if(sequence_index(seqs, "vec") && sequence_index(seqs, "list")) {
+        output << ",vecgain";
+    }
+    for(const auto& column: extra_columns) { output << "," << column; }
+    output << "\n";
 }
 
 /**
  * @brief perform #test_n for a range of values
  *
+ * @param seqs the sequences to test. If both "vec" and "list" are among them,
+ *        the last column is the list time minus the vector time
+ * @param start the first value to test
+ * @param end the last value to test
+ * @param output the output stream to write to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ */
+void test_block(const vector<NamedSequence>& seqs, size_t start, size_t end,
+                ostream& output, size_t step = 1,
+                Workload workload = Workload::uniform,
+                KeyDistribution keys = KeyDistribution::uniform)
+{
+    auto vec = sequence_index(seqs, "vec");
+    auto list = sequence_index(seqs, "list");
+    for(size_t i = start; i < end; i += step) {
+        auto durations
+            = test_n(seqs, i, DEFAULT_RUNS_PER_TEST, workload, keys);
+
+        output << i;
+        for(auto d: durations) { output << "," << d.count(); }
+        if(vec && list) {
+            output << "," << durations[*list].count() - durations[*vec].count();
+        }
+        output << endl;
+    }
+}
+
+/**
+ * @brief perform #test_n for a range of values, and report which of the
+ *        sequences was fastest for each
+ *
+ * @param seqs the sequences to compare
+ * @param start the first value to test
+ * @param end the last value to test
+ * @param output the output stream to write the times and the fastest to
+ * @param report the output stream to write a line per value to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ */
+void test_best(const vector<NamedSequence>& seqs, size_t start, size_t end,
+               ostream& output, ostream& report, size_t step = 1,
+               Workload workload = Workload::uniform,
+               KeyDistribution keys = KeyDistribution::uniform)
+{
+    for(size_t i = start; i < end; i += step) {
+        auto durations
+            = test_n(seqs, i, DEFAULT_RUNS_PER_TEST, workload, keys);
+        auto best = min_element(durations.begin(), durations.end())
+                    - durations.begin();
+
+        output << i;
+        for(auto d: durations) { output << "," << d.count(); }
+        output << "," << seqs[best].first << endl;
+        report << i << ": " << seqs[best].first << " ("
+               << durations[best].count() << "ns)" << endl;
+    }
+}
+
+/**
+ * @brief report how much memory a #BitwiseTrieSequence takes as it grows. The
+ *        trie is filled with the values of #INT_SET in order, and a row is
+ *        written every step values
+ *
+ * @param end the number of values to insert
+ * @param output the output stream to write to
+ * @param step the distance between consecutive rows
+ */
+void test_trie_memory(size_t end, ostream& output, size_t step = 1)
+{
+    assert(INT_SET.size() >= end);
+
+    output << "x,triebytes,bytesperelement\n";
+    BitwiseTrieSequence trie;
+    auto it = INT_SET.begin();
+    for(size_t i = 0; i < end; ++i, ++it) {
+        if(i % step == 0) {
+            size_t bytes = trie.bytes_used();
+            output << i << "," << bytes << ","
+                   << (i == 0 ? 0.0 : static_cast<double>(bytes) / i) << endl;
+        }
+        trie.insert_numerical(*it);
+    }
+}
+
+/**
+ * @brief time the search, shift, and index rebuild phases of an
+ *        #EytzingerVectorSequence separately, for a range of values
+ *
+ * @param start the first value to test
+ * @param end the last value to test
+ * @param output the output stream to write to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ */
+void test_eytzinger_phases(size_t start, size_t end, ostream& output,
+                           size_t step = 1,
+                           Workload workload = Workload::uniform,
+                           KeyDistribution keys = KeyDistribution::uniform)
+{
+    output << "x,searchtime,shifttime,rebuildtime\n";
+    for(size_t i = start; i < end; i += step) {
+        EytzingerPhaseTimes total;
+        for(size_t run = 0; run < DEFAULT_RUNS_PER_TEST; ++run) {
+            gen.seed(random_device{}());
+            EytzingerVectorSequence<true> seq;
+            test_n_core_(seq, make_script_(i, workload, keys));
+            total.search += seq.phase_times().search;
+            total.shift += seq.phase_times().shift;
+            total.rebuild += seq.phase_times().rebuild;
+        }
+        output << i << "," << (total.search / DEFAULT_RUNS_PER_TEST).count()
+               << "," << (total.shift / DEFAULT_RUNS_PER_TEST).count() << ","
+               << (total.rebuild / DEFAULT_RUNS_PER_TEST).count() << endl;
+    }
+}
+
+/**
+ * @brief time each of a set of sequences both through the IntegerSequence
+ *        vtable, as every other mode does, and through its #STATIC_SEQUENCES
+ *        counterpart, whose operations are direct calls. Both are run one
+ *        after the other on this thread, so that only the dispatch differs
+ *
+ * @param seqs the sequences to test, each of which has a counterpart in
+ *        #STATIC_SEQUENCES
+ * @param start the first value to test
+ * @param end the last value to test
+ * @param output the output stream to write to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ */
+void test_dispatch(const vector<NamedSequence>& seqs, size_t start,
+                   size_t end, ostream& output, size_t step = 1,
+                   Workload workload = Workload::uniform,
+                   KeyDistribution keys = KeyDistribution::uniform)
+{
+    output << "x";
+    for(const auto& [name, make]: seqs) {
+        output << "," << name << "time," << name << "statictime";
+    }
+    output << "\n";
+    for(size_t i = start; i < end; i += step) {
+        output << i;
+        for(const auto& [name, make]: seqs) {
+            // both tables are built from #REGISTERED_SEQUENCES, so any name
+            // in #SEQUENCES is here, and anything else throws
+            size_t index = sequence_index(STATIC_SEQUENCES, name).value();
+            auto dynamic
+                = test_n_(*make(), i, DEFAULT_RUNS_PER_TEST, workload, keys);
+            auto direct = STATIC_SEQUENCES[index].second(
+                i, DEFAULT_RUNS_PER_TEST, workload, keys);
+            output << "," << dynamic.count() << "," << direct.count();
+        }
+        output << endl;
+    }
+}
+
+/** The largest N the smalln mode tests */
+constexpr size_t SMALL_N_MAX = 64;
+/** How many times the smalln mode runs each script */
+constexpr size_t SMALL_N_REPS = 1000;
+
+/**
+ * @brief time each of a set of sequences per operation, for small N. Per test
+ *        times at small N are mostly clock overhead, so
+ *        here each script is run on #SMALL_N_REPS fresh instances, made and
+ *        given expect_values untimed, one after another on this thread, and
+ *        the total is divided by the number of inserts and removals
+ *
+ * @param seqs the sequences to test
+ * @param start the first value to test, at least 1
+ * @param end the last value to test
+ * @param output the output stream to write to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ */
+void test_small_n(const vector<NamedSequence>& seqs, size_t start, size_t end,
+                  ostream& output, size_t step = 1,
+                  Workload workload = Workload::uniform,
+                  KeyDistribution keys = KeyDistribution::uniform)
+{
+    assert(start >= 1);
+
+    output << "x";
+    for(const auto& [name, make]: seqs) { output << "," << name << "opns"; }
+    output << "\n";
+    for(size_t i = start; i < end; i += step) {
+        gen.seed(random_device{}());
+        TestScript script = make_script_(i, workload, keys);
+
+        output << i;
+        for(const auto& [name, make]: seqs) {
+            vector<unique_ptr<IntegerSequence>> instances;
+            for(size_t rep = 0; rep < SMALL_N_REPS; ++rep) {
+                instances.push_back(make());
+                instances.back()->expect_values(script.values);
+            }
+
+            auto t0 = chrono::high_resolution_clock::now();
+            for(auto& seq: instances) { test_n_core_(*seq, script); }
+            auto t1 = chrono::high_resolution_clock::now();
+
+            chrono::duration<double, nano> total = t1 - t0;
+            output << "," << total.count() / (SMALL_N_REPS * 2 * i);
+        }
+        output << endl;
+    }
+}
+
+/**
+ * @brief measure how scattered list nodes are after the insert phase, for a
+ *        range of values. The columns are the mean neighbour distance in bytes
+ *        of a ListAdaptor, of a #DefragListSequence, and of that
+ *        #DefragListSequence after an explicit defragment
+ *
  * @param start the first value to test
  * @param end the last value to test
  * @param output the output stream to write to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts
+ * @param keys how the values to insert are distributed
  */
-void test_block(size_t start, size_t end, ostream& output)
+void test_fragmentation(size_t start, size_t end, ostream& output,
+                        size_t step = 1, Workload workload = Workload::uniform,
+                        KeyDistribution keys = KeyDistribution::uniform)
 {
-    for(size_t i = start; i < end; i++) {
-        auto [vec_duration, list_duration] = test_n(i, DEFAULT_RUNS_PER_TEST);
+    output << "x,listdistance,defraglistdistance,defragmenteddistance\n";
+    for(size_t i = start; i < end; i += step) {
+        TestScript script = make_script_(i, workload, keys);
+        ListAdaptor<> list;
+        DefragListSequence<> defrag;
+        for(int n: script.values) {
+            list.insert_numerical(n);
+            defrag.insert_numerical(n);
+        }
+        output << i << "," << list.fragmentation() << ","
+               << defrag.fragmentation();
+        defrag.defragment();
+        output << "," << defrag.fragmentation() << endl;
+    }
+}
 
-        output << i << "," << vec_duration.count() << ","
-               << list_duration.count() << ","
-               << list_duration.count() - vec_duration.count() << endl;
+/**
+ * @brief INTERNAL: replay script on seq and on a VectorAdaptor, comparing
+ *        their contents after every insert and every removal
+ *
+ * @param seq the sequence to check, empty
+ * @param script the values to insert, in order, and then the indices to
+ *        remove, in order
+ * @return optional<size_t> the number of operations after which seq first
+ *         differed from the vector, or nullopt if it never did
+ */
+optional<size_t> verify_script_(IntegerSequence& seq, const TestScript& script)
+{
+    VectorAdaptor<> reference;
+    size_t ops = 0;
+    auto same = [&] {
+        ++ops;
+        return seq.size() == reference.size()
+               && seq.to_vector() == reference.to_vector();
+    };
+    for(int n: script.values) {
+        seq.insert_numerical(n);
+        reference.insert_numerical(n);
+        if(!same()) { return ops; }
     }
+    for(size_t i: script.removal_indices) {
+        seq.remove(i);
+        reference.remove(i);
+        if(!same()) { return ops; }
+    }
+    return {};
 }
 
 /**
- * @brief parse command line arguments and return the number of tests to run
+ * @brief check that each of a set of sequences holds the right values, for a
+ *        range of values. Each sequence replays the same script as a
+ *        VectorAdaptor, and their contents are compared after every step
+ *
+ * @param seqs the sequences to check
+ * @param start the first value to test
+ * @param end the last value to test
+ * @param report the output stream to write a line per mismatch to
+ * @param step the distance between consecutive values tested
+ * @param workload how to order the inserts and removals
+ * @param keys how the values to insert are distributed
+ * @return bool true if every sequence matched the vector at every step
+ */
+bool test_verify(const vector<NamedSequence>& seqs, size_t start, size_t end,
+                 ostream& report, size_t step = 1,
+                 Workload workload = Workload::uniform,
+                 KeyDistribution keys = KeyDistribution::uniform)
+{
+    bool ok = true;
+    for(size_t i = start; i < end; i += step) {
+        gen.seed(random_device{}());
+        TestScript script = make_script_(i, workload, keys);
+        for(const auto& [name, make]: seqs) {
+            auto seq = make();
+            seq->expect_values(script.values);
+            if(auto ops = verify_script_(*seq, script)) {
+                report << name << ": wrong contents at N = " << i
+                       << " after " << *ops << " operations" << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+/** The experiments #LvvArgs::mode may name */
+const vector<string> MODES
+    = {"compare", "smalln",   "calibrate",     "blocksize",
+       "prefetch", "memory",  "phases",    "payload",
+       "dispatch", "fragmentation", "verify"};
+
+/**
+ * @brief parsed command line arguments
+ */
+struct LvvArgs {
+    /**
+     * the experiment to run: "compare" to time each of #seqs, "smalln" to
+     * time each of #seqs per operation up to #SMALL_N_MAX, "calibrate"
+     * to find where each pair of #seqs cross over, "blocksize"
+     * to find the best #TIERED_SEQUENCES block size, "prefetch" to find the
+     * best #PREFETCH_SEQUENCES prefetch distance, "memory" to measure
+     * the bytes per element of a #BitwiseTrieSequence, "phases" to time
+     * the phases of an #EytzingerVectorSequence, "payload" to time the
+     * #PAYLOAD_SEQUENCES, "dispatch" to time each of #seqs with and without
+     * virtual calls, "fragmentation" to measure how scattered list nodes
+     * are, or "verify" to check the contents of each of #seqs against a
+     * vector
+     */
+    string mode = "compare";
+    /** the number of tests to run */
+    size_t num_tests = DEFAULT_NUM_TESTS;
+    /** the distance between consecutive tests */
+    size_t step = 1;
+    /** how to order the inserts and removals */
+    Workload workload = Workload::uniform;
+    /** how the values to insert are distributed */
+    KeyDistribution keys = KeyDistribution::uniform;
+    /** the sequences to test */
+    vector<NamedSequence> seqs = SEQUENCES;
+};
+
+/**
+ * @brief print usage and exit with failure
+ *
+ * @param prog the name of the program
+ */
+[[noreturn]] void lvv_usage(const string& prog)
+{
+    cerr << "Usage: " << prog << " [optional: ";
+    for(size_t i = 0; i < MODES.size(); ++i) {
+        cerr << (i == 0 ? "" : "|") << MODES[i];
+    }
+    cerr << "]"
+         << " [optional: number of tests to run] [--step k]"
+            " [--only name[,name...]] [--workload uniform|clustered]"
+            " [--keys uniform|normal|exponential]\n"
+         << "sequences:";
+    for(const auto& [name, make]: SEQUENCES) { cerr << " " << name; }
+    cerr << endl;
+    exit(1);
+}
+
+/**
+ * @brief parse command line arguments
  *
  * @param argv command line arguments
- * @return size_t the number of tests to run (#DEFAULT_NUM_TESTS if no argument
- *         is found)
+ * @return LvvArgs the parsed arguments, with defaults for anything not given
  */
-size_t lvv_parse_args(vector<string> argv)
+LvvArgs lvv_parse_args(vector<string> argv)
 {
     size_t argc = argv.size();
     if(argc < 1) {
@@ -250,37 +1250,192 @@ size_t lvv_parse_args(vector<string> argv)
         assert(false);
         exit(1);
     }
-    if(argc == 1) { return DEFAULT_NUM_TESTS; }
-    if(argc > 2) {
-        cerr << "Usage: " << argv[0] << " [optional: number of tests to run]"
-             << endl;
-        exit(1);
+
+    LvvArgs args;
+    bool have_num_tests = false;
+    size_t first = 1;
+    if(argc > 1 && ranges::find(MODES, argv[1]) != MODES.end()) {
+        args.mode = argv[1];
+        first = 2;
     }
-    assert(argc == 2);
+    for(size_t i = first; i < argc; ++i) {
+        if(argv[i] == "--step" && i + 1 < argc) {
+            int step = stoi(argv[++i]);
+            if(step < 1) {
+                cerr << "Step must be positive" << endl;
+                exit(1);
+            }
+            args.step = step;
+        }
+        else if(argv[i] == "--workload" && i + 1 < argc) {
+            string workload = argv[++i];
+            if(workload == "uniform") { args.workload = Workload::uniform; }
+            else if(workload == "clustered") {
+                args.workload = Workload::clustered;
+            }
+            else {
+                lvv_usage(argv[0]);
+            }
+        }
+        else if(argv[i] == "--keys" && i + 1 < argc) {
+            string keys = argv[++i];
+            if(keys == "uniform") { args.keys = KeyDistribution::uniform; }
+            else if(keys == "normal") { args.keys = KeyDistribution::normal; }
+            else if(keys == "exponential") {
+                args.keys = KeyDistribution::exponential;
+            }
+            else {
+                lvv_usage(argv[0]);
+            }
+        }
+        else if(argv[i] == "--only" && i + 1 < argc) {
+            args.seqs.clear();
+            istringstream names{argv[++i]};
+            string name;
+            while(getline(names, name, ',')) {
+                auto idx = sequence_index(SEQUENCES, name);
+                if(!idx) {
+                    cerr << "Unknown sequence: " << name << endl;
+                    lvv_usage(argv[0]);
+                }
+                args.seqs.push_back(SEQUENCES[*idx]);
+            }
+            if(args.seqs.empty()) { lvv_usage(argv[0]); }
+        }
+        else if(!have_num_tests && !argv[i].starts_with("--")) {
+            int tests = stoi(argv[i]);
 
-    int tests = stoi(argv[1]);
+            if(tests < 0) {
+                cerr << "Number of tests must be non-negative" << endl;
+                exit(1);
+            }
 
-    if(tests < 0) {
-        cerr << "Number of tests must be non-negative" << endl;
-        exit(1);
-    }
+            if(tests > MAX_TESTS) {
+                cerr << "Number of tests must be less than " << MAX_TESTS
+                     << endl;
+                exit(1);
+            }
 
-    if(tests > MAX_TESTS) {
-        cerr << "Number of tests must be less than " << MAX_TESTS << endl;
-        exit(1);
+            args.num_tests = tests;
+            have_num_tests = true;
+        }
+        else {
+            lvv_usage(argv[0]);
+        }
     }
 
-    return tests;
+    return args;
 }
 
 int main(int argc, char const* argv[])
 {
-    size_t num_tests = lvv_parse_args(vector<string>{argv, argv + argc});
+    LvvArgs args = lvv_parse_args(vector<string>{argv, argv + argc});
+
+    if(args.mode == "calibrate") {
+        auto crossovers = calibrate(args.seqs, args.num_tests, cout);
+        vector<string> measured;
+        for(const auto& [name, make]: args.seqs) { measured.push_back(name); }
+        crossovers = calibration::merge_crossovers(
+            calibration::read_crossovers().value_or(
+                vector<calibration::Crossover>{}),
+            crossovers, measured);
+
+        std::ofstream outfile(calibration::CROSSOVER_REL_PATH);
+        calibration::write_crossovers(crossovers, outfile);
+
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "verify") {
+        bool ok = test_verify(args.seqs, 0, args.num_tests, cout, args.step,
+                              args.workload, args.keys);
+        cout << (ok ? "all sequences match" : "mismatches found") << endl;
+        return ok ? 0 : 1;
+    }
+
+    if(args.mode == "smalln") {
+        std::ofstream outfile("smalln.csv");
+        test_small_n(args.seqs, 1, min(args.num_tests, SMALL_N_MAX + 1),
+                     outfile, args.step, args.workload, args.keys);
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "blocksize") {
+        std::ofstream outfile("blocksize.csv");
+        write_header(TIERED_SEQUENCES, outfile, {"best"});
+
+        test_best(TIERED_SEQUENCES, 0, args.num_tests, outfile, cout,
+                  args.step, args.workload, args.keys);
+
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "prefetch") {
+        std::ofstream outfile("prefetch.csv");
+        write_header(PREFETCH_SEQUENCES, outfile, {"best"});
+
+        test_best(PREFETCH_SEQUENCES, 0, args.num_tests, outfile, cout,
+                  args.step, args.workload, args.keys);
+
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "memory") {
+        std::ofstream outfile("memory.csv");
+        test_trie_memory(args.num_tests, outfile, args.step);
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "phases") {
+        std::ofstream outfile("phases.csv");
+        test_eytzinger_phases(0, args.num_tests, outfile, args.step,
+                              args.workload, args.keys);
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "payload") {
+        std::ofstream outfile("payload.csv");
+        write_header(PAYLOAD_SEQUENCES, outfile);
+
+        test_block(PAYLOAD_SEQUENCES, 0, args.num_tests, outfile, args.step,
+                   args.workload, args.keys);
+
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "dispatch") {
+#if !defined(__OPTIMIZE__)
+        cerr << "warning: built without optimization, so the direct calls are"
+                " not inlined and the two times mostly agree. Build with"
+                " 'make opt' and run " << argv[0] << "_opt instead" << endl;
+#endif
+        std::ofstream outfile("dispatch.csv");
+        test_dispatch(args.seqs, 0, args.num_tests, outfile, args.step,
+                      args.workload, args.keys);
+        outfile.close();
+        return 0;
+    }
+
+    if(args.mode == "fragmentation") {
+        std::ofstream outfile("fragmentation.csv");
+        test_fragmentation(0, args.num_tests, outfile, args.step,
+                           args.workload, args.keys);
+        outfile.close();
+        return 0;
+    }
 
     std::ofstream outfile("out.csv");
-    outfile << "x,vectime,listtime,vecgain\n";
+    write_header(args.seqs, outfile);
 
-    test_block(0, num_tests, outfile);
+    test_block(args.seqs, 0, args.num_tests, outfile, args.step,
+               args.workload, args.keys);
 
     outfile.close();
 }
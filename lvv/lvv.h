@@ -1,14 +1,33 @@
 #ifndef LVV_H
 #define LVV_H
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
 #include <future>
 #include <iostream>
+#include <iterator>
 #include <list>
+#include <memory>
+#include <memory_resource>
+#include <new>
 #include <random>
 #include <unordered_set>
 #include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LVV_X86_DISPATCH
+#include <immintrin.h>
+#endif
 
 /**
  * @brief A random number generator
@@ -69,10 +88,12 @@ namespace utils {
     /**
      * @brief insert n into v in numerical order
      *
+     * @tparam T the element type of v, ordered by <
      * @param v vector to insert into
      * @param n value to insert
      */
-    void insert_in_numerical_order(std::vector<int>& v, int n)
+    template<class T>
+    void insert_in_numerical_order(std::vector<T>& v, const T& n)
     {
         if(v.empty()) {
             v.push_back(n);
@@ -87,10 +108,13 @@ namespace utils {
     /**
      * @brief insert n into l in numerical order
      *
+     * @tparam T the element type of l, ordered by <
+     * @tparam Alloc the allocator of l
      * @param l list to insert into
      * @param n value to insert
      */
-    void insert_in_numerical_order(std::list<int>& l, int n)
+    template<class T, class Alloc>
+    void insert_in_numerical_order(std::list<T, Alloc>& l, const T& n)
     {
         if(l.empty()) {
             l.push_back(n);
@@ -102,8 +126,267 @@ namespace utils {
         l.insert(it, n);
     }
 
+    /**
+     * @brief measure how scattered the nodes of l are
+     * @details the mean distance in bytes between the addresses of neighbouring
+     *          elements, which for a list laid out contiguously in traversal
+     *          order is the size of a node
+     *
+     * @tparam T the element type of l
+     * @tparam Alloc the allocator of l
+     * @param l the list to measure
+     * @return double the mean neighbour distance, 0 if l has fewer than two
+     *         elements
+     */
+    template<class T, class Alloc>
+    double mean_neighbour_distance(const std::list<T, Alloc>& l)
+    {
+        if(l.size() < 2) { return 0; }
+        double total = 0;
+        auto prev = reinterpret_cast<uintptr_t>(&l.front());
+        for(auto it = std::next(l.begin()); it != l.end(); ++it) {
+            auto addr = reinterpret_cast<uintptr_t>(&*it);
+            total += addr > prev ? addr - prev : prev - addr;
+            prev = addr;
+        }
+        return total / (l.size() - 1);
+    }
+
+    /**
+     * @brief count the elements of [first, first + len) that are less than n
+     * @details branchless, and four lanes at a time where SSE2 is available.
+     *          On a sorted range this is the index std::lower_bound would find
+     *
+     * @param first the first element to compare
+     * @param len the number of elements to compare
+     * @param n the value to compare against
+     * @return size_t the number of elements less than n
+     */
+    size_t count_less(const int* first, size_t len, int n)
+    {
+        size_t count = 0;
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi32(n);
+        __m128i acc = _mm_setzero_si128();
+        for(; i + 4 <= len; i += 4) {
+            __m128i vals = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(first + i));
+            // a true lane is all ones, i.e. -1
+            acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(vals, needle));
+        }
+        alignas(16) std::array<int, 4> lanes;
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), acc);
+        count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for(const int* p = first + i; p != first + len; ++p) {
+            count += *p < n;
+        }
+        return count;
+    }
+
+    /**
+     * @brief INTERNAL: the scalar #find_insert_position kernel
+     */
+    size_t find_insert_position_scalar_(const int* first, size_t len, int n)
+    {
+        size_t i = 0;
+        while(i < len && first[i] < n) { ++i; }
+        return i;
+    }
+
+#if defined(LVV_X86_DISPATCH)
+    /**
+     * @brief INTERNAL: the SSE2 #find_insert_position kernel
+     */
+    __attribute__((target("sse2"))) size_t
+    find_insert_position_sse2_(const int* first, size_t len, int n)
+    {
+        const __m128i needle = _mm_set1_epi32(n);
+        size_t i = 0;
+        for(; i + 4 <= len; i += 4) {
+            __m128i vals = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(first + i));
+            unsigned mask = _mm_movemask_ps(
+                _mm_castsi128_ps(_mm_cmplt_epi32(vals, needle)));
+            if(mask != 0xf) { return i + std::popcount(mask); }
+        }
+        return i + find_insert_position_scalar_(first + i, len - i, n);
+    }
+
+    /**
+     * @brief INTERNAL: the AVX2 #find_insert_position kernel
+     */
+    __attribute__((target("avx2"))) size_t
+    find_insert_position_avx2_(const int* first, size_t len, int n)
+    {
+        const __m256i needle = _mm256_set1_epi32(n);
+        size_t i = 0;
+        for(; i + 8 <= len; i += 8) {
+            __m256i vals = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(first + i));
+            unsigned mask = _mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, vals)));
+            if(mask != 0xff) { return i + std::popcount(mask); }
+        }
+        return i + find_insert_position_scalar_(first + i, len - i, n);
+    }
+#endif
+
+    /**
+     * @brief a kernel for #find_insert_position
+     */
+    using FindInsertPosition = size_t (*)(const int*, size_t, int);
+
+    /**
+     * @brief INTERNAL: pick the widest #find_insert_position kernel this CPU
+     *        supports
+     */
+    FindInsertPosition pick_find_insert_position_()
+    {
+#if defined(LVV_X86_DISPATCH)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) {
+            return find_insert_position_avx2_;
+        }
+        if(__builtin_cpu_supports("sse2")) {
+            return find_insert_position_sse2_;
+        }
+#endif
+        return find_insert_position_scalar_;
+    }
+
+    /**
+     * @brief find the index of the first element of the sorted range
+     *        [first, first + len) that is not less than n
+     * @details a linear scan, like #insert_in_numerical_order, but comparing
+     *          eight (AVX2) or four (SSE2) lanes at a time and counting the
+     *          lanes less than n from a movemask, so there is one branch per
+     *          chunk. The kernel is picked once at startup from the running
+     *          CPU, with a scalar fallback
+     *
+     * @param first the first element of the range
+     * @param len the number of elements in the range
+     * @param n the value to find the position of
+     * @return size_t the number of elements less than n
+     */
+    const FindInsertPosition find_insert_position
+        = pick_find_insert_position_();
+
+    /**
+     * @brief a Fenwick tree over the counts of a row of slots
+     * @details adding to a slot and summing the slots before one are
+     *          O(log n), as is finding the slot that holds the ith counted
+     *          item, which is what makes it an index by rank
+     */
+    class FenwickTree {
+    private:
+        // 1-based, tree[r] is the total of slots [r - lowbit(r), r)
+        std::vector<size_t> tree = std::vector<size_t>(1);
+    public:
+        FenwickTree() = default;
+        /**
+         * @brief replace the slots, in O(n)
+         *
+         * @param counts the count of each slot
+         */
+        void assign(const std::vector<size_t>& counts)
+        {
+            tree.assign(1, 0);
+            tree.insert(tree.end(), counts.begin(), counts.end());
+            // push each node's total up to its parent
+            for(size_t r = 1; r < tree.size(); ++r) {
+                size_t parent = r + (r & -r);
+                if(parent < tree.size()) { tree[parent] += tree[r]; }
+            }
+        }
+        /**
+         * @brief the count of each slot, in O(n), by undoing #assign
+         */
+        std::vector<size_t> counts() const
+        {
+            std::vector<size_t> points = tree;
+            for(size_t r = points.size() - 1; r > 0; --r) {
+                size_t parent = r + (r & -r);
+                if(parent < points.size()) { points[parent] -= points[r]; }
+            }
+            return {points.begin() + 1, points.end()};
+        }
+        /**
+         * @brief add delta to the count of slot
+         */
+        void add(size_t slot, long delta)
+        {
+            for(size_t r = slot + 1; r < tree.size(); r += r & -r) {
+                tree[r] += delta;
+            }
+        }
+        /**
+         * @brief the total count of slots [0, slot)
+         */
+        size_t prefix(size_t slot) const
+        {
+            size_t sum = 0;
+            for(size_t r = slot; r > 0; r -= r & -r) { sum += tree[r]; }
+            return sum;
+        }
+        /**
+         * @brief add a slot with a count of 0 to the end
+         */
+        void push_back()
+        {
+            size_t r = tree.size();
+            tree.push_back(prefix(r - 1) - prefix(r - (r & -r)));
+        }
+        /**
+         * @brief find the slot that holds the ith counted item
+         *
+         * @param i the rank of the item, less than the total count. Set to
+         *        its rank within the slot
+         * @return size_t the largest slot with at most i items before it
+         */
+        size_t find(size_t& i) const
+        {
+            size_t slot = 0;
+            for(size_t step = std::bit_floor(tree.size() - 1); step > 0;
+                step /= 2) {
+                if(slot + step < tree.size() && tree[slot + step] <= i) {
+                    slot += step;
+                    i -= tree[slot];
+                }
+            }
+            return slot;
+        }
+    };
+
 } // namespace utils
 
+/**
+ * @brief an element of BYTES bytes, ordered by an int key
+ * @details the key is all a sequence looks at; the rest is padding, so that
+ *          sequences of Payloads show how the size of an element changes the
+ *          cost of shifting it and of chasing a pointer to it. A sequence of
+ *          4 byte elements is a sequence of plain ints
+ *
+ * @tparam BYTES the size of the element
+ */
+template<size_t BYTES>
+struct Payload {
+    static_assert(BYTES > sizeof(int) && BYTES % alignof(int) == 0,
+                  "a payload is a key plus a whole number of ints");
+    /** the key the element is ordered by */
+    int key;
+    /** the padding that makes the element BYTES long */
+    std::array<std::byte, BYTES - sizeof(int)> rest{};
+
+    friend bool operator<(const Payload& a, const Payload& b)
+    {
+        return a.key < b.key;
+    }
+    /** the key */
+    explicit operator int() const { return key; }
+};
+
 /**
  * @brief abstract base class for a sequence of integers
  */
@@ -117,12 +400,16 @@ public:
     virtual void insert_numerical(int n) = 0;
     /**
      * @brief push n onto the end of the sequence
+     * @note a sequence kept in numerical order asserts that n is greater than
+     *       every value in it
      *
      * @param n the value to push
      */
     virtual void push_back(int n) = 0;
     /**
      * @brief push n onto the front of the sequence
+     * @note a sequence kept in numerical order asserts that n is less than
+     *       every value in it
      *
      * @param n the value to push
      */
@@ -146,6 +433,24 @@ public:
      * @return false if the sequence is not empty
      */
     virtual bool empty() = 0;
+    /**
+     * @brief return the values in the sequence, in order
+     * @details for checking a sequence's contents, never on a timed path
+     *
+     * @return std::vector<int> the values in the sequence, in order
+     */
+    virtual std::vector<int> to_vector() const = 0;
+    /**
+     * @brief tell an empty sequence which values are going to be inserted
+     * @details called before a timed run, so a sequence that can make use of
+     *          knowing its values up front can prepare for them untimed. Does
+     *          nothing by default
+     *
+     * @param values the values that will be inserted, in any order
+     */
+    virtual void expect_values([[maybe_unused]] const std::vector<int>& values)
+    {
+    }
     virtual ~IntegerSequence() = default;
 
     /**
@@ -171,19 +476,26 @@ public:
 
 /**
  * @brief Adaptor class for list<int> to IntegerSequence
+ *
+ * @tparam T the element type, an int or a #Payload made from the int it is
+ *         given
+ * @tparam Alloc the allocator of the list, which every insert allocates a node
+ *         from and every remove frees one to
  */
+template<class T = int, class Alloc = std::allocator<T>>
 class ListAdaptor : public IntegerSequence {
 private:
-    std::list<int> l;
+    std::list<T, Alloc> l;
 public:
-    explicit ListAdaptor(std::list<int> const& l): l(l) {}
+    explicit ListAdaptor(std::list<T, Alloc> const& l): l(l) {}
+    explicit ListAdaptor(const Alloc& alloc): l(alloc) {}
     ListAdaptor() = default;
     void insert_numerical(int n) override
     {
-        utils::insert_in_numerical_order(l, n);
+        utils::insert_in_numerical_order(l, T{n});
     }
-    void push_back(int n) override { l.push_back(n); }
-    void push_front(int n) override { l.push_front(n); }
+    void push_back(int n) override { l.push_back(T{n}); }
+    void push_front(int n) override { l.push_front(T{n}); }
     void remove(size_t i) override
     {
         auto it = l.begin();
@@ -192,28 +504,2691 @@ public:
     }
     size_t size() override { return l.size(); }
     bool empty() override { return l.empty(); }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(l.size());
+        for(const T& x: l) { vals.push_back(static_cast<int>(x)); }
+        return vals;
+    }
+    /**
+     * @brief how scattered the nodes are
+     *
+     * @see utils::mean_neighbour_distance
+     */
+    double fragmentation() const { return utils::mean_neighbour_distance(l); }
     ~ListAdaptor() override = default;
 };
 
+/**
+ * @brief the size of a std::list<int> node in the usual implementations: two
+ *        links and an int, padded to the alignment of a link
+ */
+constexpr size_t LIST_NODE_BYTES = (2 * sizeof(void*) + sizeof(int)
+                                    + alignof(void*) - 1)
+                                   / alignof(void*) * alignof(void*);
+
+/**
+ * @brief a pool of equal-sized blocks
+ * @details blocks are carved out of slabs of SLAB_BLOCKS at a time, or as many
+ *          as reserve asks for, and freed blocks are threaded onto a free list
+ *          to be handed out again, so after warming up an allocation is a
+ *          couple of loads and stores. The block size is fixed by the first
+ *          allocation or reservation. Slabs are only returned when the pool is
+ *          destroyed
+ */
+class FixedBlockPool {
+private:
+    static constexpr size_t SLAB_BLOCKS = 4096;
+
+    size_t block_size = 0;
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+    // the unused tail of the newest slab is [next, end)
+    std::byte* next = nullptr;
+    std::byte* end = nullptr;
+    // each free block holds a pointer to the next
+    void* free_list = nullptr;
+
+    void set_block_size(size_t bytes, size_t align)
+    {
+        assert(align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        block_size = std::max(bytes, sizeof(void*));
+        block_size = (block_size + align - 1) / align * align;
+    }
+    void add_slab(size_t blocks)
+    {
+        // blocks are written before they are read, so skip zeroing the slab
+        slabs.push_back(
+            std::make_unique_for_overwrite<std::byte[]>(blocks * block_size));
+        next = slabs.back().get();
+        end = next + blocks * block_size;
+    }
+public:
+    /**
+     * @brief allocate a block
+     *
+     * @param bytes the size of the block, the same on every call
+     * @param align the alignment of the block
+     * @return void* the block
+     */
+    void* allocate(size_t bytes, size_t align)
+    {
+        if(block_size == 0) { set_block_size(bytes, align); }
+        assert(bytes <= block_size);
+
+        if(free_list) {
+            void* block = free_list;
+            free_list = *static_cast<void**>(block);
+            return block;
+        }
+        if(next == end) { add_slab(SLAB_BLOCKS); }
+        void* block = next;
+        next += block_size;
+        return block;
+    }
+    /**
+     * @brief make sure the next n allocations do not need a new slab
+     *
+     * @param bytes the size of a block, as allocate will be given it
+     * @param align the alignment of a block
+     * @param n the number of blocks to have ready
+     */
+    void reserve(size_t bytes, size_t align, size_t n)
+    {
+        if(block_size == 0) { set_block_size(bytes, align); }
+        assert(bytes <= block_size);
+
+        if(static_cast<size_t>(end - next) < n * block_size) { add_slab(n); }
+    }
+    /**
+     * @brief return a block to the pool
+     *
+     * @param block a block from allocate
+     */
+    void deallocate(void* block)
+    {
+        *static_cast<void**>(block) = free_list;
+        free_list = block;
+    }
+};
+
+/**
+ * @brief an allocator that serves single objects from a shared #FixedBlockPool
+ * @details meant for node-based containers, which only allocate nodes of one
+ *          type. Arrays go to std::allocator. Copies, including rebound ones,
+ *          share the pool
+ *
+ * @tparam T the type to allocate
+ */
+template<class T> class NodePoolAllocator {
+public:
+    using value_type = T;
+
+    std::shared_ptr<FixedBlockPool> pool = std::make_shared<FixedBlockPool>();
+
+    NodePoolAllocator() = default;
+    template<class U>
+    NodePoolAllocator(const NodePoolAllocator<U>& other): pool(other.pool)
+    {
+    }
+    T* allocate(size_t n)
+    {
+        if(n != 1) { return std::allocator<T>{}.allocate(n); }
+        return static_cast<T*>(pool->allocate(sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t n)
+    {
+        if(n != 1) { std::allocator<T>{}.deallocate(p, n); }
+        else {
+            pool->deallocate(p);
+        }
+    }
+    template<class U> bool operator==(const NodePoolAllocator<U>& other) const
+    {
+        return pool == other.pool;
+    }
+};
+
+/**
+ * @brief a ListAdaptor that allocates its nodes from a #FixedBlockPool
+ * @details expect_values reserves a slab for every node up front, so a run
+ *          does not pay for carving out the first one
+ */
+class NodePoolListAdaptor final
+    : public ListAdaptor<int, NodePoolAllocator<int>> {
+private:
+    // shared with the list's allocator
+    std::shared_ptr<FixedBlockPool> pool;
+
+    explicit NodePoolListAdaptor(const NodePoolAllocator<int>& alloc)
+        : ListAdaptor<int, NodePoolAllocator<int>>(alloc), pool(alloc.pool)
+    {
+    }
+public:
+    NodePoolListAdaptor(): NodePoolListAdaptor(NodePoolAllocator<int>{}) {}
+    void expect_values(const std::vector<int>& values) override
+    {
+        assert(empty());
+        pool->reserve(LIST_NODE_BYTES, alignof(void*), values.size());
+    }
+    ~NodePoolListAdaptor() override = default;
+};
+
+/**
+ * @brief a memory resource that bumps a pointer through one buffer
+ * @details deallocation does nothing, and reset rewinds to the start of the
+ *          buffer. Whatever does not fit in the buffer goes to the new/delete
+ *          resource
+ */
+class BumpArenaResource : public std::pmr::memory_resource {
+private:
+    std::vector<std::byte> buf;
+    size_t used = 0;
+
+    bool owns(void* p) const
+    {
+        auto* b = static_cast<std::byte*>(p);
+        return b >= buf.data() && b < buf.data() + buf.size();
+    }
+protected:
+    void* do_allocate(size_t bytes, size_t align) override
+    {
+        size_t start = (used + align - 1) / align * align;
+        if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+           || start + bytes > buf.size()) {
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        used = start + bytes;
+        return buf.data() + start;
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override
+    {
+        if(!owns(p)) {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other)
+        const noexcept override
+    {
+        return this == &other;
+    }
+public:
+    /**
+     * @brief rewind to the start of the buffer, growing it to capacity bytes.
+     *        Nothing allocated from the buffer may still be in use
+     *
+     * @param capacity the number of bytes the buffer should hold
+     */
+    void reset(size_t capacity)
+    {
+        used = 0;
+        if(buf.size() < capacity) { buf.resize(capacity); }
+    }
+};
+
+/**
+ * @brief INTERNAL: holds a memory resource, so that as a base listed before
+ *        a container's it is constructed before and destroyed after the
+ *        container
+ */
+template<class Resource> struct ResourceHolder_ {
+    Resource resource;
+};
+
+/**
+ * @brief a ListAdaptor that allocates from a Resource of its own
+ *
+ * @tparam Resource the std::pmr::memory_resource to allocate from
+ */
+template<class Resource>
+class PmrListAdaptor
+    : protected ResourceHolder_<Resource>,
+      public ListAdaptor<int, std::pmr::polymorphic_allocator<int>> {
+public:
+    PmrListAdaptor()
+        : ListAdaptor<int, std::pmr::polymorphic_allocator<int>>(
+              &this->resource)
+    {
+    }
+    ~PmrListAdaptor() override = default;
+};
+
+/**
+ * @brief a ListAdaptor that allocates from a #BumpArenaResource
+ * @details the arena is sized for every node up front by expect_values, and
+ *          rewound there, i.e. between runs. This pre-allocates the list
+ *          elements, so inserts never call malloc and removes never call free
+ */
+class ArenaListAdaptor final : public PmrListAdaptor<BumpArenaResource> {
+public:
+    ArenaListAdaptor() = default;
+    void expect_values(const std::vector<int>& values) override
+    {
+        assert(empty());
+        resource.reset(values.size() * LIST_NODE_BYTES);
+    }
+    ~ArenaListAdaptor() override = default;
+};
+
 /**
  * @brief Adaptor class for vector<int> to IntegerSequence
+ *
+ * @tparam T the element type, an int or a #Payload made from the int it is
+ *         given
  */
-class VectorAdaptor : public IntegerSequence {
+template<class T = int>
+class VectorAdaptor final : public IntegerSequence {
 private:
-    std::vector<int> v;
+    std::vector<T> v;
 public:
-    explicit VectorAdaptor(std::vector<int> const& v): v(v) {}
+    explicit VectorAdaptor(std::vector<T> const& v): v(v) {}
     VectorAdaptor() = default;
     void insert_numerical(int n) override
     {
-        utils::insert_in_numerical_order(v, n);
+        utils::insert_in_numerical_order(v, T{n});
+    }
+    void push_back(int n) override { v.push_back(T{n}); }
+    void push_front(int n) override { v.insert(v.begin(), T{n}); }
+    void remove(size_t i) override { v.erase(v.begin() + i); }
+    size_t size() override { return v.size(); }
+    bool empty() override { return v.empty(); }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(v.size());
+        for(const T& x: v) { vals.push_back(static_cast<int>(x)); }
+        return vals;
+    }
+    ~VectorAdaptor() override = default;
+};
+
+/**
+ * @brief Adaptor class for vector<int> to IntegerSequence that finds insert
+ *        positions with utils::find_insert_position
+ * @details the same linear scan as VectorAdaptor, but vectorized and
+ *          dispatched on the running CPU
+ */
+class SimdVectorAdaptor final : public IntegerSequence {
+private:
+    std::vector<int> v;
+public:
+    explicit SimdVectorAdaptor(std::vector<int> const& v): v(v) {}
+    SimdVectorAdaptor() = default;
+    void insert_numerical(int n) override
+    {
+        v.insert(v.begin() + utils::find_insert_position(v.data(), v.size(), n),
+                 n);
     }
     void push_back(int n) override { v.push_back(n); }
     void push_front(int n) override { v.insert(v.begin(), n); }
     void remove(size_t i) override { v.erase(v.begin() + i); }
     size_t size() override { return v.size(); }
     bool empty() override { return v.empty(); }
-    ~VectorAdaptor() override = default;
+    std::vector<int> to_vector() const override { return v; }
+    ~SimdVectorAdaptor() override = default;
+};
+
+/**
+ * @brief a sorted vector of integers that finds insert positions by
+ *        interpolation search
+ * @details each probe guesses the position of n from where it falls between
+ *          the values at the ends of the remaining range, which takes an
+ *          expected O(log log n) probes on uniformly distributed values. On
+ *          skewed values interpolation can take O(n) probes, so after a
+ *          couple of times the expected number it falls back to a binary
+ *          search of whatever range is left
+ */
+class InterpolationVectorSequence final : public IntegerSequence {
+private:
+    std::vector<int> v;
+
+    /** the index of the first value not less than n */
+    size_t search(int n) const
+    {
+        size_t lo = 0;
+        size_t hi = v.size();
+        size_t probes = 2 * std::bit_width(std::bit_width(v.size())) + 2;
+        for(; probes > 0 && lo < hi; --probes) {
+            long long first = v[lo];
+            long long last = v[hi - 1];
+            if(n <= first) { return lo; }
+            if(n > last) { return hi; }
+            // first < n <= last, so lo <= pos < hi
+            size_t pos = lo
+                         + static_cast<size_t>((n - first) * (hi - 1 - lo)
+                                               / (last - first));
+            if(v[pos] < n) { lo = pos + 1; }
+            else {
+                hi = pos;
+            }
+        }
+        return std::lower_bound(v.begin() + lo, v.begin() + hi, n) - v.begin();
+    }
+public:
+    InterpolationVectorSequence() = default;
+    void insert_numerical(int n) override
+    {
+        v.insert(v.begin() + search(n), n);
+    }
+    void push_back(int n) override { v.push_back(n); }
+    void push_front(int n) override { v.insert(v.begin(), n); }
+    void remove(size_t i) override { v.erase(v.begin() + i); }
+    size_t size() override { return v.size(); }
+    bool empty() override { return v.empty(); }
+    std::vector<int> to_vector() const override { return v; }
+    ~InterpolationVectorSequence() override = default;
+};
+
+/**
+ * @brief Adaptor class for an order-statistic tree to IntegerSequence
+ * @details a red-black tree whose nodes also track the size of their subtree,
+ *          so finding the ith element (and therefore both insert_numerical and
+ *          remove) is O(log n). The tree is keyed on value, so values must be
+ *          distinct and push_back / push_front must not break numerical order.
+ */
+class OrderStatisticTreeAdaptor final : public IntegerSequence {
+private:
+    __gnu_pbds::tree<int, __gnu_pbds::null_type, std::less<int>,
+                     __gnu_pbds::rb_tree_tag,
+                     __gnu_pbds::tree_order_statistics_node_update>
+        t;
+public:
+    OrderStatisticTreeAdaptor() = default;
+    void insert_numerical(int n) override
+    {
+        [[maybe_unused]] bool inserted = t.insert(n).second;
+        assert(inserted);
+    }
+    void push_back(int n) override
+    {
+        assert(t.empty() || *std::prev(t.end()) < n);
+        t.insert(n);
+    }
+    void push_front(int n) override
+    {
+        assert(t.empty() || n < *t.begin());
+        t.insert(n);
+    }
+    void remove(size_t i) override { t.erase(t.find_by_order(i)); }
+    size_t size() override { return t.size(); }
+    bool empty() override { return t.empty(); }
+    std::vector<int> to_vector() const override { return {t.begin(), t.end()}; }
+    ~OrderStatisticTreeAdaptor() override = default;
+};
+
+/**
+ * @brief a counted B+-tree of integers
+ * @details leaves are cache-line-sized sorted int arrays, and inner nodes keep
+ *          the running total of their children's sizes so the ith element can
+ *          be found by rank. Unused slots are padded with INT_MAX so that every
+ *          in-node search is a branchless utils::count_less over the whole
+ *          node. Nodes are freed once empty rather than merged on underflow,
+ *          which keeps removal simple at the cost of some sparsity after heavy
+ *          removal. Sizes are tracked as int, so at most INT_MAX - 1 elements
+ *
+ * @tparam LEAF_CAP the number of ints in a leaf
+ * @tparam FANOUT the maximum number of children of an inner node
+ */
+template<size_t LEAF_CAP = 16, size_t FANOUT = 16>
+class CountedBTreeSequence final : public IntegerSequence {
+private:
+    static_assert(LEAF_CAP >= 2 && FANOUT >= 3);
+
+    struct Node {
+        // number of keys in a leaf, number of children of an inner node
+        size_t n = 0;
+        virtual ~Node() = default;
+    };
+    struct Leaf : Node {
+        alignas(64) std::array<int, LEAF_CAP> keys;
+        Leaf() { keys.fill(INT_MAX); }
+    };
+    struct Inner : Node {
+        // keys[j] is a lower bound on children[j], keys[0] is always INT_MIN
+        alignas(64) std::array<int, FANOUT> keys;
+        // counts[j] is the number of keys in children[0..j]
+        alignas(64) std::array<int, FANOUT> counts;
+        std::array<std::unique_ptr<Node>, FANOUT> children;
+        Inner()
+        {
+            keys.fill(INT_MAX);
+            keys[0] = INT_MIN;
+            counts.fill(INT_MAX);
+        }
+    };
+    /** the result of inserting into a node: its new right sibling, if any */
+    struct Split {
+        int key = 0;
+        std::unique_ptr<Node> node;
+    };
+
+    std::unique_ptr<Node> root = std::make_unique<Leaf>();
+    // 0 when the root is a leaf
+    size_t height = 0;
+    size_t count = 0;
+
+    static int size_of(const Node* node, size_t h)
+    {
+        if(h == 0) { return static_cast<int>(node->n); }
+        return static_cast<const Inner*>(node)->counts[node->n - 1];
+    }
+
+    static void insert_child(Inner* inner, size_t at, Split split, int size)
+    {
+        assert(inner->n < FANOUT && at > 0 && at <= inner->n);
+        for(size_t k = inner->n; k > at; --k) {
+            inner->keys[k] = inner->keys[k - 1];
+            inner->counts[k] = inner->counts[k - 1];
+            inner->children[k] = std::move(inner->children[k - 1]);
+        }
+        inner->keys[at] = split.key;
+        inner->counts[at] = inner->counts[at - 1];
+        inner->counts[at - 1] -= size;
+        inner->children[at] = std::move(split.node);
+        ++inner->n;
+    }
+
+    static Split insert(Node* node, size_t h, int n)
+    {
+        if(h == 0) {
+            auto* leaf = static_cast<Leaf*>(node);
+            size_t pos = utils::count_less(leaf->keys.data(), LEAF_CAP, n);
+            if(leaf->n < LEAF_CAP) {
+                std::copy_backward(leaf->keys.begin() + pos,
+                                   leaf->keys.begin() + leaf->n,
+                                   leaf->keys.begin() + leaf->n + 1);
+                leaf->keys[pos] = n;
+                ++leaf->n;
+                return {};
+            }
+
+            auto right = std::make_unique<Leaf>();
+            constexpr size_t half = LEAF_CAP / 2;
+            std::copy(leaf->keys.begin() + half, leaf->keys.end(),
+                      right->keys.begin());
+            std::fill(leaf->keys.begin() + half, leaf->keys.end(), INT_MAX);
+            leaf->n = half;
+            right->n = LEAF_CAP - half;
+            insert(pos <= half ? leaf : right.get(), 0, n);
+            return {right->keys[0], std::move(right)};
+        }
+
+        auto* inner = static_cast<Inner*>(node);
+        size_t j = std::max<size_t>(
+                       utils::count_less(inner->keys.data(), FANOUT, n), 1)
+                   - 1;
+        Split split = insert(inner->children[j].get(), h - 1, n);
+        for(size_t k = j; k < inner->n; ++k) { ++inner->counts[k]; }
+        if(!split.node) { return {}; }
+
+        int split_size = size_of(split.node.get(), h - 1);
+        if(inner->n < FANOUT) {
+            insert_child(inner, j + 1, std::move(split), split_size);
+            return {};
+        }
+
+        auto right = std::make_unique<Inner>();
+        constexpr size_t mid = FANOUT / 2;
+        int moved = inner->counts[mid - 1];
+        for(size_t k = mid; k < FANOUT; ++k) {
+            right->keys[k - mid] = inner->keys[k];
+            right->counts[k - mid] = inner->counts[k] - moved;
+            right->children[k - mid] = std::move(inner->children[k]);
+            inner->keys[k] = INT_MAX;
+            inner->counts[k] = INT_MAX;
+        }
+        int right_key = right->keys[0];
+        right->keys[0] = INT_MIN;
+        inner->n = mid;
+        right->n = FANOUT - mid;
+        if(j + 1 <= mid) {
+            insert_child(inner, j + 1, std::move(split), split_size);
+        }
+        else {
+            insert_child(right.get(), j + 1 - mid, std::move(split),
+                         split_size);
+        }
+        return {right_key, std::move(right)};
+    }
+
+    /** append the keys under node, h levels above the leaves, to vals */
+    static void gather(const Node* node, size_t h, std::vector<int>& vals)
+    {
+        if(h == 0) {
+            auto* leaf = static_cast<const Leaf*>(node);
+            vals.insert(vals.end(), leaf->keys.begin(),
+                        leaf->keys.begin() + leaf->n);
+            return;
+        }
+        auto* inner = static_cast<const Inner*>(node);
+        for(size_t j = 0; j < inner->n; ++j) {
+            gather(inner->children[j].get(), h - 1, vals);
+        }
+    }
+
+    /** the smallest key if !last, else the largest, of a non-empty tree */
+    int edge_key(bool last) const
+    {
+        const Node* node = root.get();
+        for(size_t h = height; h > 0; --h) {
+            auto* inner = static_cast<const Inner*>(node);
+            node = inner->children[last ? inner->n - 1 : 0].get();
+        }
+        auto* leaf = static_cast<const Leaf*>(node);
+        return leaf->keys[last ? leaf->n - 1 : 0];
+    }
+
+    /** returns true if node is left empty */
+    static bool remove(Node* node, size_t h, int i)
+    {
+        if(h == 0) {
+            auto* leaf = static_cast<Leaf*>(node);
+            std::copy(leaf->keys.begin() + i + 1, leaf->keys.begin() + leaf->n,
+                      leaf->keys.begin() + i);
+            leaf->keys[--leaf->n] = INT_MAX;
+            return leaf->n == 0;
+        }
+
+        auto* inner = static_cast<Inner*>(node);
+        size_t j = utils::count_less(inner->counts.data(), FANOUT, i + 1);
+        int before = j == 0 ? 0 : inner->counts[j - 1];
+        bool child_empty = remove(inner->children[j].get(), h - 1, i - before);
+        for(size_t k = j; k < inner->n; ++k) { --inner->counts[k]; }
+        if(!child_empty) { return false; }
+
+        for(size_t k = j; k + 1 < inner->n; ++k) {
+            inner->keys[k] = inner->keys[k + 1];
+            inner->counts[k] = inner->counts[k + 1];
+            inner->children[k] = std::move(inner->children[k + 1]);
+        }
+        --inner->n;
+        inner->keys[inner->n] = INT_MAX;
+        inner->counts[inner->n] = INT_MAX;
+        inner->children[inner->n].reset();
+        inner->keys[0] = INT_MIN;
+        return inner->n == 0;
+    }
+public:
+    CountedBTreeSequence() = default;
+    void insert_numerical(int n) override
+    {
+        assert(count < INT_MAX - 1);
+        Split split = insert(root.get(), height, n);
+        ++count;
+        if(!split.node) { return; }
+
+        auto new_root = std::make_unique<Inner>();
+        new_root->counts[0] = size_of(root.get(), height);
+        new_root->counts[1] = static_cast<int>(count);
+        new_root->keys[1] = split.key;
+        new_root->children[0] = std::move(root);
+        new_root->children[1] = std::move(split.node);
+        new_root->n = 2;
+        root = std::move(new_root);
+        ++height;
+    }
+    void push_back(int n) override
+    {
+        assert(count == 0 || edge_key(true) < n);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(count == 0 || n < edge_key(false));
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        if(remove(root.get(), height, static_cast<int>(i))) {
+            root = std::make_unique<Leaf>();
+            height = 0;
+        }
+        while(height > 0 && root->n == 1) {
+            root = std::move(static_cast<Inner*>(root.get())->children[0]);
+            --height;
+        }
+        --count;
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        gather(root.get(), height, vals);
+        return vals;
+    }
+    ~CountedBTreeSequence() override = default;
+};
+
+/**
+ * @brief a tiered vector of integers
+ * @details the sequence is split into contiguous blocks of at most BLOCK_SIZE
+ *          ints, so an insertion or removal shifts at most BLOCK_SIZE ints,
+ *          plus the small block index when a block splits or empties. Blocks
+ *          are found by a binary search on their last values when inserting
+ *          and by walking the block sizes when removing
+ *
+ * @tparam BLOCK_SIZE the maximum number of ints in a block
+ */
+template<size_t BLOCK_SIZE = 512>
+class TieredVectorSequence final : public IntegerSequence {
+private:
+    static_assert(BLOCK_SIZE >= 2);
+
+    // never holds an empty block
+    std::vector<std::vector<int>> blocks;
+    size_t count = 0;
+
+    /** split block b if it has grown past BLOCK_SIZE */
+    void split_if_full(typename std::vector<std::vector<int>>::iterator b)
+    {
+        if(b->size() <= BLOCK_SIZE) { return; }
+        std::vector<int> upper;
+        upper.reserve(BLOCK_SIZE + 1);
+        upper.assign(b->begin() + b->size() / 2, b->end());
+        b->resize(b->size() / 2);
+        blocks.insert(b + 1, std::move(upper));
+    }
+
+    /** make sure there is a block to insert into */
+    void ensure_block()
+    {
+        if(!blocks.empty()) { return; }
+        blocks.emplace_back();
+        blocks.back().reserve(BLOCK_SIZE + 1);
+    }
+public:
+    TieredVectorSequence() = default;
+    void insert_numerical(int n) override
+    {
+        ensure_block();
+        // the first block whose values do not all precede n, else the last
+        auto b = std::partition_point(
+            blocks.begin(), blocks.end() - 1,
+            [n](const std::vector<int>& block) { return block.back() < n; });
+        utils::insert_in_numerical_order(*b, n);
+        ++count;
+        split_if_full(b);
+    }
+    void push_back(int n) override
+    {
+        ensure_block();
+        blocks.back().push_back(n);
+        ++count;
+        split_if_full(blocks.end() - 1);
+    }
+    void push_front(int n) override
+    {
+        ensure_block();
+        blocks.front().insert(blocks.front().begin(), n);
+        ++count;
+        split_if_full(blocks.begin());
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        auto b = blocks.begin();
+        while(i >= b->size()) {
+            i -= b->size();
+            ++b;
+        }
+        b->erase(b->begin() + i);
+        --count;
+        if(b->empty()) { blocks.erase(b); }
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(const auto& block: blocks) {
+            vals.insert(vals.end(), block.begin(), block.end());
+        }
+        return vals;
+    }
+    ~TieredVectorSequence() override = default;
+};
+
+/**
+ * @brief a gap buffer of integers
+ * @details one contiguous buffer with a single gap that is moved to wherever
+ *          the next edit happens, so an edit costs element moves proportional
+ *          to its distance from the previous edit rather than to the size of
+ *          the sequence. Insert positions are found by a binary search on
+ *          either side of the gap
+ */
+class GapBufferSequence final : public IntegerSequence {
+private:
+    std::vector<int> buf;
+    // the gap is buf[gap_begin, gap_end)
+    size_t gap_begin = 0;
+    size_t gap_end = 0;
+
+    /** move the gap so that it starts at logical index pos */
+    void move_gap(size_t pos)
+    {
+        if(pos < gap_begin) {
+            std::copy_backward(buf.begin() + pos, buf.begin() + gap_begin,
+                               buf.begin() + gap_end);
+            gap_end -= gap_begin - pos;
+            gap_begin = pos;
+        }
+        else if(pos > gap_begin) {
+            size_t dist = pos - gap_begin;
+            std::copy(buf.begin() + gap_end, buf.begin() + gap_end + dist,
+                      buf.begin() + gap_begin);
+            gap_begin += dist;
+            gap_end += dist;
+        }
+    }
+
+    void insert_at(size_t pos, int n)
+    {
+        if(gap_begin == gap_end) {
+            // double the buffer, and move everything after the gap to the end
+            size_t tail = buf.size() - gap_end;
+            buf.resize(std::max<size_t>(16, 2 * buf.size()));
+            std::copy_backward(buf.begin() + gap_end,
+                               buf.begin() + gap_end + tail, buf.end());
+            gap_end = buf.size() - tail;
+        }
+        move_gap(pos);
+        buf[gap_begin++] = n;
+    }
+public:
+    GapBufferSequence() = default;
+    void insert_numerical(int n) override
+    {
+        auto before = buf.begin() + gap_begin;
+        auto it = std::lower_bound(buf.begin(), before, n);
+        if(it != before) {
+            insert_at(it - buf.begin(), n);
+            return;
+        }
+        auto after = buf.begin() + gap_end;
+        insert_at(gap_begin + (std::lower_bound(after, buf.end(), n) - after),
+                  n);
+    }
+    void push_back(int n) override { insert_at(size(), n); }
+    void push_front(int n) override { insert_at(0, n); }
+    void remove(size_t i) override
+    {
+        assert(i < size());
+        move_gap(i);
+        ++gap_end;
+    }
+    size_t size() override { return buf.size() - (gap_end - gap_begin); }
+    bool empty() override { return size() == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals(buf.begin(), buf.begin() + gap_begin);
+        vals.insert(vals.end(), buf.begin() + gap_end, buf.end());
+        return vals;
+    }
+    ~GapBufferSequence() override = default;
+};
+
+/**
+ * @brief a packed memory array of integers
+ * @details a sorted array with gaps, split into segments of SEGMENT_SIZE slots
+ *          whose values are packed to the left. An implicit binary tree over
+ *          the segments holds the count and the maximum of every window of
+ *          segments, which gives O(log n) search by value and by rank. When an
+ *          insertion overflows a segment, the smallest enclosing window that is
+ *          within its density threshold is spread out evenly, so insertion
+ *          costs amortized O(log^2 n) moves; removals rebalance the same way
+ *          when a segment gets too sparse. The array doubles or halves when the
+ *          whole of it is out of bounds
+ *
+ * @tparam SEGMENT_SIZE the number of slots in a segment
+ */
+template<size_t SEGMENT_SIZE = 32>
+class PackedMemoryArraySequence final : public IntegerSequence {
+private:
+    static_assert(SEGMENT_SIZE >= 2);
+
+    // the number of segments, a power of two
+    size_t segs = 1;
+    // log2(segs), i.e. the depth of a segment in the tree
+    size_t height = 0;
+    std::vector<int> slots = std::vector<int>(SEGMENT_SIZE);
+    // node 1 is the whole array, node v has children 2v and 2v + 1, and
+    // segment k is node segs + k
+    std::vector<size_t> counts = std::vector<size_t>(2);
+    // meaningless where the count is 0
+    std::vector<int> maxes = std::vector<int>(2);
+
+    /** the upper density bound of a window d levels above the segments */
+    double upper(size_t d) const
+    {
+        return height == 0 ? 1.0 : 1.0 - 0.25 * d / height;
+    }
+    /** the lower density bound of a window d levels above the segments */
+    double lower(size_t d) const
+    {
+        return height == 0 ? 0.125 : 0.125 + 0.125 * d / height;
+    }
+
+    int* segment(size_t v) { return slots.data() + (v - segs) * SEGMENT_SIZE; }
+
+    /** recompute node v from its children */
+    void pull(size_t v)
+    {
+        counts[v] = counts[2 * v] + counts[2 * v + 1];
+        maxes[v] = counts[2 * v + 1] ? maxes[2 * v + 1] : maxes[2 * v];
+    }
+
+    /** recompute every ancestor of node v */
+    void pull_ancestors(size_t v)
+    {
+        for(v /= 2; v >= 1; v /= 2) { pull(v); }
+    }
+
+    /** append the values of the window at node v, d levels up, to vals */
+    void gather(size_t v, size_t d, std::vector<int>& vals)
+    {
+        for(size_t leaf = v << d; leaf < (v + 1) << d; ++leaf) {
+            vals.insert(vals.end(), segment(leaf), segment(leaf) + counts[leaf]);
+        }
+    }
+
+    /** spread vals evenly over the window at node v, d levels up */
+    void spread(size_t v, size_t d, const std::vector<int>& vals)
+    {
+        size_t first = v << d;
+        size_t num = size_t{1} << d;
+        assert(vals.size() <= num * SEGMENT_SIZE);
+        for(size_t k = 0; k < num; ++k) {
+            size_t b = vals.size() * k / num;
+            size_t e = vals.size() * (k + 1) / num;
+            std::copy(vals.begin() + b, vals.begin() + e, segment(first + k));
+            counts[first + k] = e - b;
+            maxes[first + k] = e > b ? vals[e - 1] : INT_MIN;
+        }
+        for(size_t level = 1; level <= d; ++level) {
+            for(size_t u = v << (d - level); u < (v + 1) << (d - level); ++u) {
+                pull(u);
+            }
+        }
+        pull_ancestors(v);
+    }
+
+    /** the smallest value of a non-empty array */
+    int front() const
+    {
+        size_t v = 1;
+        while(v < segs) { v = counts[2 * v] ? 2 * v : 2 * v + 1; }
+        return slots[(v - segs) * SEGMENT_SIZE];
+    }
+
+    /** reallocate with new_segs segments, and spread vals over them */
+    void resize(size_t new_segs, const std::vector<int>& vals)
+    {
+        segs = new_segs;
+        height = std::countr_zero(segs);
+        slots.assign(segs * SEGMENT_SIZE, 0);
+        counts.assign(2 * segs, 0);
+        maxes.assign(2 * segs, INT_MIN);
+        spread(1, height, vals);
+    }
+public:
+    PackedMemoryArraySequence() = default;
+    void insert_numerical(int n) override
+    {
+        size_t v = 1;
+        while(v < segs) {
+            size_t l = 2 * v;
+            if(counts[l] && maxes[l] >= n) { v = l; }
+            else if(counts[l + 1]) { v = l + 1; }
+            else { v = l; }
+        }
+
+        if(counts[v] < SEGMENT_SIZE) {
+            int* seg = segment(v);
+            int* pos = std::lower_bound(seg, seg + counts[v], n);
+            std::copy_backward(pos, seg + counts[v], seg + counts[v] + 1);
+            *pos = n;
+            maxes[v] = seg[counts[v]++];
+            pull_ancestors(v);
+            return;
+        }
+
+        size_t d = 0;
+        while(v > 1 && counts[v] + 1 > upper(d) * (SEGMENT_SIZE << d)) {
+            v /= 2;
+            ++d;
+        }
+        std::vector<int> vals;
+        vals.reserve(counts[v] + 1);
+        gather(v, d, vals);
+        vals.insert(std::lower_bound(vals.begin(), vals.end(), n), n);
+        if(counts[v] + 1 > upper(d) * (SEGMENT_SIZE << d)) {
+            resize(2 * segs, vals);
+        }
+        else {
+            spread(v, d, vals);
+        }
+    }
+    void push_back(int n) override
+    {
+        assert(counts[1] == 0 || maxes[1] < n);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(counts[1] == 0 || n < front());
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < counts[1]);
+        size_t v = 1;
+        while(v < segs) {
+            if(i < counts[2 * v]) { v = 2 * v; }
+            else {
+                i -= counts[2 * v];
+                v = 2 * v + 1;
+            }
+        }
+
+        int* seg = segment(v);
+        std::copy(seg + i + 1, seg + counts[v], seg + i);
+        --counts[v];
+        maxes[v] = counts[v] ? seg[counts[v] - 1] : INT_MIN;
+        pull_ancestors(v);
+
+        size_t d = 0;
+        while(v > 1 && counts[v] < lower(d) * (SEGMENT_SIZE << d)) {
+            v /= 2;
+            ++d;
+        }
+        if(d == 0) { return; }
+        std::vector<int> vals;
+        vals.reserve(counts[v]);
+        gather(v, d, vals);
+        if(counts[v] < lower(d) * (SEGMENT_SIZE << d)) {
+            resize(segs / 2, vals);
+        }
+        else {
+            spread(v, d, vals);
+        }
+    }
+    size_t size() override { return counts[1]; }
+    bool empty() override { return counts[1] == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(counts[1]);
+        for(size_t k = 0; k < segs; ++k) {
+            auto seg = slots.begin() + k * SEGMENT_SIZE;
+            vals.insert(vals.end(), seg, seg + counts[segs + k]);
+        }
+        return vals;
+    }
+    ~PackedMemoryArraySequence() override = default;
+};
+
+/**
+ * @brief a double-ended vector of integers
+ * @details one contiguous buffer with spare capacity at both ends. An edit
+ *          shifts whichever side of it is shorter, so an edit at a uniformly
+ *          random position moves n / 4 elements on average rather than n / 2,
+ *          and push_front is amortized O(1). When the side to shift into has
+ *          no room, the buffer is regrown with the values centred in it.
+ *          Insert positions are found by a binary search
+ */
+class DevectorSequence final : public IntegerSequence {
+private:
+    std::vector<int> buf;
+    // the values are buf[first, last)
+    size_t first = 0;
+    size_t last = 0;
+
+    /** reallocate so that there is room on both sides of the values */
+    void regrow()
+    {
+        size_t n = last - first;
+        std::vector<int> grown(std::max<size_t>(16, 2 * n + 2));
+        size_t new_first = (grown.size() - n) / 2;
+        std::copy(buf.begin() + first, buf.begin() + last,
+                  grown.begin() + new_first);
+        buf = std::move(grown);
+        first = new_first;
+        last = new_first + n;
+    }
+
+    void insert_at(size_t pos, int n)
+    {
+        bool front = pos < (last - first) / 2;
+        if(front ? first == 0 : last == buf.size()) { regrow(); }
+        auto at = buf.begin() + first + pos;
+        if(front) {
+            std::copy(buf.begin() + first, at, buf.begin() + first - 1);
+            --first;
+            *(at - 1) = n;
+        }
+        else {
+            std::copy_backward(at, buf.begin() + last, buf.begin() + last + 1);
+            ++last;
+            *at = n;
+        }
+    }
+public:
+    DevectorSequence() = default;
+    void insert_numerical(int n) override
+    {
+        auto it = std::lower_bound(buf.begin() + first, buf.begin() + last, n);
+        insert_at(it - (buf.begin() + first), n);
+    }
+    void push_back(int n) override { insert_at(size(), n); }
+    void push_front(int n) override { insert_at(0, n); }
+    void remove(size_t i) override
+    {
+        assert(i < size());
+        auto at = buf.begin() + first + i;
+        if(i < size() / 2) {
+            std::copy_backward(buf.begin() + first, at, at + 1);
+            ++first;
+        }
+        else {
+            std::copy(at + 1, buf.begin() + last, at);
+            --last;
+        }
+    }
+    size_t size() override { return last - first; }
+    bool empty() override { return first == last; }
+    std::vector<int> to_vector() const override
+    {
+        return {buf.begin() + first, buf.begin() + last};
+    }
+    ~DevectorSequence() override = default;
+};
+
+/**
+ * @brief an unrolled linked list of integers
+ * @details a linked list whose nodes each hold up to NODE_CAP sorted ints and a
+ *          count, so walking the list costs one cache miss per node rather than
+ *          per element. A full node is split in two, and an empty node is
+ *          unlinked
+ *
+ * @tparam NODE_CAP the maximum number of ints in a node
+ */
+template<size_t NODE_CAP = 32>
+class UnrolledListSequence final : public IntegerSequence {
+private:
+    static_assert(NODE_CAP >= 2);
+
+    struct Node {
+        size_t n = 0;
+        std::array<int, NODE_CAP> vals;
+    };
+
+    // never holds an empty node
+    std::list<Node> nodes;
+    size_t count = 0;
+
+    /** insert n at index pos of node it, splitting it if it is full */
+    void insert_at(typename std::list<Node>::iterator it, size_t pos, int n)
+    {
+        if(it->n == NODE_CAP) {
+            constexpr size_t half = NODE_CAP / 2;
+            auto right = nodes.emplace(std::next(it));
+            std::copy(it->vals.begin() + half, it->vals.end(),
+                      right->vals.begin());
+            right->n = NODE_CAP - half;
+            it->n = half;
+            if(pos > half) {
+                it = right;
+                pos -= half;
+            }
+        }
+        std::copy_backward(it->vals.begin() + pos, it->vals.begin() + it->n,
+                           it->vals.begin() + it->n + 1);
+        it->vals[pos] = n;
+        ++it->n;
+        ++count;
+    }
+
+    /** make sure there is a node to insert into */
+    void ensure_node()
+    {
+        if(nodes.empty()) { nodes.emplace_back(); }
+    }
+public:
+    UnrolledListSequence() = default;
+    void insert_numerical(int n) override
+    {
+        ensure_node();
+        // the first node whose values do not all precede n, else the last
+        auto it = nodes.begin();
+        while(std::next(it) != nodes.end() && it->vals[it->n - 1] < n) {
+            ++it;
+        }
+        size_t pos = 0;
+        while(pos < it->n && it->vals[pos] < n) { ++pos; }
+        insert_at(it, pos, n);
+    }
+    void push_back(int n) override
+    {
+        ensure_node();
+        insert_at(std::prev(nodes.end()), nodes.back().n, n);
+    }
+    void push_front(int n) override
+    {
+        ensure_node();
+        insert_at(nodes.begin(), 0, n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        auto it = nodes.begin();
+        while(i >= it->n) {
+            i -= it->n;
+            ++it;
+        }
+        std::copy(it->vals.begin() + i + 1, it->vals.begin() + it->n,
+                  it->vals.begin() + i);
+        --count;
+        if(--it->n == 0) { nodes.erase(it); }
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(const Node& node: nodes) {
+            vals.insert(vals.end(), node.vals.begin(),
+                        node.vals.begin() + node.n);
+        }
+        return vals;
+    }
+    ~UnrolledListSequence() override = default;
+};
+
+/**
+ * @brief an indexable skip list of integers
+ * @details a skip list whose links also record how many elements they skip,
+ *          so the ith element can be found by position as well as by value,
+ *          both in expected O(log n). Node levels are drawn from the global
+ *          #gen, so they are reproducible for a given seed
+ */
+class SkipListSequence final : public IntegerSequence {
+private:
+    static constexpr size_t MAX_LEVEL = 32;
+
+    struct Node;
+    struct Link {
+        Node* next = nullptr;
+        // the number of positions from this node to next, where the head is
+        // position 0 and a null next is position size() + 1
+        size_t width = 1;
+    };
+    // a node is allocated with its links right after it, so that a node is
+    // one allocation and a level step is one load
+    struct alignas(Link) Node {
+        int val = 0;
+        Link* links() { return reinterpret_cast<Link*>(this + 1); }
+    };
+
+    Node* head = make_node(MAX_LEVEL, 0);
+    // the number of levels in use
+    size_t level = 1;
+    size_t count = 0;
+
+    /** allocate a node holding n with lvl links */
+    static Node* make_node(size_t lvl, int n)
+    {
+        void* mem = ::operator new(sizeof(Node) + lvl * sizeof(Link));
+        auto* node = new(mem) Node{n};
+        std::uninitialized_value_construct_n(node->links(), lvl);
+        return node;
+    }
+
+    static void free_node(Node* node) { ::operator delete(node); }
+
+    /** the last node, the head if the list is empty */
+    Node* last() const
+    {
+        Node* x = head;
+        for(size_t l = level; l-- > 0;) {
+            while(x->links()[l].next) { x = x->links()[l].next; }
+        }
+        return x;
+    }
+
+    static size_t random_level()
+    {
+        size_t lvl = 1;
+        while(lvl < MAX_LEVEL && utils::random_int(0, 1)) { ++lvl; }
+        return lvl;
+    }
+public:
+    SkipListSequence() = default;
+    SkipListSequence(const SkipListSequence&) = delete;
+    SkipListSequence& operator=(const SkipListSequence&) = delete;
+    void insert_numerical(int n) override
+    {
+        std::array<Node*, MAX_LEVEL> update;
+        std::array<size_t, MAX_LEVEL> rank;
+        Node* x = head;
+        size_t pos = 0;
+        for(size_t l = level; l-- > 0;) {
+            while(x->links()[l].next && x->links()[l].next->val < n) {
+                pos += x->links()[l].width;
+                x = x->links()[l].next;
+            }
+            update[l] = x;
+            rank[l] = pos;
+        }
+
+        size_t lvl = random_level();
+        for(; level < lvl; ++level) {
+            update[level] = head;
+            rank[level] = 0;
+            head->links()[level] = {nullptr, count + 1};
+        }
+
+        Node* node = make_node(lvl, n);
+        for(size_t l = 0; l < lvl; ++l) {
+            Link& prev = update[l]->links()[l];
+            node->links()[l] = {prev.next, prev.width - (pos - rank[l])};
+            prev = {node, pos - rank[l] + 1};
+        }
+        for(size_t l = lvl; l < level; ++l) { ++update[l]->links()[l].width; }
+        ++count;
+    }
+    void push_back(int n) override
+    {
+        assert(count == 0 || last()->val < n);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(count == 0 || n < head->links()[0].next->val);
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        std::array<Node*, MAX_LEVEL> update{};
+        Node* x = head;
+        size_t pos = 0;
+        for(size_t l = level; l-- > 0;) {
+            while(x->links()[l].next && pos + x->links()[l].width <= i) {
+                pos += x->links()[l].width;
+                x = x->links()[l].next;
+            }
+            update[l] = x;
+        }
+
+        Node* target = update[0]->links()[0].next;
+        for(size_t l = 0; l < level; ++l) {
+            Link& prev = update[l]->links()[l];
+            if(prev.next == target) {
+                prev = {target->links()[l].next,
+                        prev.width + target->links()[l].width - 1};
+            }
+            else {
+                --prev.width;
+            }
+        }
+        free_node(target);
+        while(level > 1 && !head->links()[level - 1].next) { --level; }
+        --count;
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(Node* x = head->links()[0].next; x; x = x->links()[0].next) {
+            vals.push_back(x->val);
+        }
+        return vals;
+    }
+    ~SkipListSequence() override
+    {
+        // iteratively, so a long list does not overflow the stack
+        Node* x = head;
+        while(x) {
+            Node* next = x->links()[0].next;
+            free_node(x);
+            x = next;
+        }
+    }
+};
+
+/**
+ * @brief an offline sequence of integers over a known universe
+ * @details the values to be inserted are given up front by expect_values and
+ *          coordinate-compressed, and a Fenwick tree over their ranks records
+ *          which are present. insert_numerical and remove are then O(log n)
+ *          with a tiny constant, which makes this a lower bound for the other
+ *          sequences. Inserting a value outside the universe is supported but
+ *          rebuilds the tree in O(n)
+ */
+class FenwickSequence final : public IntegerSequence {
+private:
+    // sorted and distinct
+    std::vector<int> universe;
+    // a slot per rank, 1 if that value is present
+    utils::FenwickTree tree;
+    size_t count = 0;
+
+    /** the number of present values less than n */
+    size_t count_below(int n) const
+    {
+        return tree.prefix(std::lower_bound(universe.begin(), universe.end(), n)
+                           - universe.begin());
+    }
+
+    /** the present values, in order */
+    std::vector<int> present() const
+    {
+        std::vector<size_t> points = tree.counts();
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(size_t r = 0; r < points.size(); ++r) {
+            if(points[r]) { vals.push_back(universe[r]); }
+        }
+        return vals;
+    }
+
+    /**
+     * rebuild over universe, with the values in present, which is sorted and
+     * a subset of universe, present
+     */
+    void rebuild(const std::vector<int>& present)
+    {
+        std::vector<size_t> points(universe.size());
+        // both are sorted, so walk them together
+        size_t r = 0;
+        for(int n: present) {
+            while(universe[r] < n) { ++r; }
+            points[r] = 1;
+        }
+        tree.assign(points);
+    }
+public:
+    FenwickSequence() = default;
+    void expect_values(const std::vector<int>& values) override
+    {
+        assert(count == 0);
+        universe = values;
+        std::sort(universe.begin(), universe.end());
+        universe.erase(std::unique(universe.begin(), universe.end()),
+                       universe.end());
+        tree.assign(std::vector<size_t>(universe.size()));
+    }
+    void insert_numerical(int n) override
+    {
+        auto it = std::lower_bound(universe.begin(), universe.end(), n);
+        if(it == universe.end() || *it != n) {
+            std::vector<int> vals = present();
+            vals.insert(std::lower_bound(vals.begin(), vals.end(), n), n);
+            universe.insert(it, n);
+            rebuild(vals);
+            ++count;
+            return;
+        }
+        tree.add(it - universe.begin(), 1);
+        ++count;
+    }
+    void push_back(int n) override
+    {
+        assert(count_below(n) == count);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(count_below(n) == 0);
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        tree.add(tree.find(i), -1);
+        --count;
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override { return present(); }
+    ~FenwickSequence() override = default;
+};
+
+/**
+ * @brief a bitwise trie of integers with subtree counts
+ * @details each int, with its sign bit flipped so that unsigned order is
+ *          numerical order, is split into four bytes. The first three pick a
+ *          path through inner nodes and the last sets a bit in a 256-bit leaf,
+ *          so every operation visits a constant number of levels. Inner nodes
+ *          are sparse: they keep only their non-empty children, sorted by
+ *          byte, with the number of values under each so that the ith value
+ *          can be found by rank
+ */
+class BitwiseTrieSequence final : public IntegerSequence {
+private:
+    static constexpr size_t LEVELS = 3;
+
+    struct Node {
+        virtual ~Node() = default;
+    };
+    struct Leaf : Node {
+        std::array<uint64_t, 4> bits{};
+    };
+    struct Inner : Node {
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> counts;
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    Inner root;
+    size_t count = 0;
+
+    static uint8_t byte_of(uint32_t key, size_t level)
+    {
+        return static_cast<uint8_t>(key >> (24 - 8 * level));
+    }
+
+    /**
+     * append the values under node, at level, to vals, where prefix holds the
+     * key bytes above level
+     */
+    static void gather(const Node* node, size_t level, uint32_t prefix,
+                       std::vector<int>& vals)
+    {
+        if(level == LEVELS) {
+            auto* leaf = static_cast<const Leaf*>(node);
+            for(size_t w = 0; w < leaf->bits.size(); ++w) {
+                for(uint64_t bits = leaf->bits[w]; bits; bits &= bits - 1) {
+                    uint32_t key = prefix | (64 * w + std::countr_zero(bits));
+                    vals.push_back(static_cast<int>(key ^ 0x8000'0000u));
+                }
+            }
+            return;
+        }
+        auto* inner = static_cast<const Inner*>(node);
+        for(size_t j = 0; j < inner->children.size(); ++j) {
+            gather(inner->children[j].get(), level + 1,
+                   prefix | uint32_t{inner->bytes[j]} << (24 - 8 * level),
+                   vals);
+        }
+    }
+
+    /** the number of values less than n */
+    size_t count_below(int n) const
+    {
+        uint32_t key = static_cast<uint32_t>(n) ^ 0x8000'0000u;
+        const Inner* inner = &root;
+        size_t below = 0;
+        for(size_t level = 0;; ++level) {
+            uint8_t b = byte_of(key, level);
+            size_t j = 0;
+            for(; j < inner->bytes.size() && inner->bytes[j] < b; ++j) {
+                below += inner->counts[j];
+            }
+            if(j == inner->bytes.size() || inner->bytes[j] != b) {
+                return below;
+            }
+            if(level + 1 == LEVELS) {
+                auto* leaf = static_cast<const Leaf*>(inner->children[j].get());
+                uint8_t last = byte_of(key, LEVELS);
+                for(size_t w = 0; w < last / 64u; ++w) {
+                    below += std::popcount(leaf->bits[w]);
+                }
+                return below
+                       + std::popcount(leaf->bits[last / 64]
+                                       & ((uint64_t{1} << (last % 64)) - 1));
+            }
+            inner = static_cast<const Inner*>(inner->children[j].get());
+        }
+    }
+
+    static size_t bytes_used(const Node* node, size_t level)
+    {
+        if(level == LEVELS) { return sizeof(Leaf); }
+        auto* inner = static_cast<const Inner*>(node);
+        size_t bytes = sizeof(Inner) + inner->bytes.capacity()
+                       + inner->counts.capacity() * sizeof(uint32_t)
+                       + inner->children.capacity()
+                             * sizeof(std::unique_ptr<Node>);
+        for(const auto& child: inner->children) {
+            bytes += bytes_used(child.get(), level + 1);
+        }
+        return bytes;
+    }
+public:
+    BitwiseTrieSequence() = default;
+    void insert_numerical(int n) override
+    {
+        uint32_t key = static_cast<uint32_t>(n) ^ 0x8000'0000u;
+        Inner* inner = &root;
+        for(size_t level = 0;; ++level) {
+            uint8_t b = byte_of(key, level);
+            size_t j = std::lower_bound(inner->bytes.begin(),
+                                        inner->bytes.end(), b)
+                       - inner->bytes.begin();
+            if(j == inner->bytes.size() || inner->bytes[j] != b) {
+                inner->bytes.insert(inner->bytes.begin() + j, b);
+                inner->counts.insert(inner->counts.begin() + j, 0);
+                inner->children.insert(
+                    inner->children.begin() + j,
+                    level + 1 == LEVELS
+                        ? std::unique_ptr<Node>(std::make_unique<Leaf>())
+                        : std::make_unique<Inner>());
+            }
+            ++inner->counts[j];
+            if(level + 1 == LEVELS) {
+                auto* leaf = static_cast<Leaf*>(inner->children[j].get());
+                uint8_t last = byte_of(key, LEVELS);
+                assert(!(leaf->bits[last / 64] >> (last % 64) & 1));
+                leaf->bits[last / 64] |= uint64_t{1} << (last % 64);
+                break;
+            }
+            inner = static_cast<Inner*>(inner->children[j].get());
+        }
+        ++count;
+    }
+    void push_back(int n) override
+    {
+        assert(count_below(n) == count);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(count_below(n) == 0);
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        --count;
+        Inner* inner = &root;
+        for(size_t level = 0;; ++level) {
+            size_t j = 0;
+            while(i >= inner->counts[j]) { i -= inner->counts[j++]; }
+            if(inner->counts[j] == 1) {
+                // the value is the only one under this child
+                inner->bytes.erase(inner->bytes.begin() + j);
+                inner->counts.erase(inner->counts.begin() + j);
+                inner->children.erase(inner->children.begin() + j);
+                return;
+            }
+            --inner->counts[j];
+            if(level + 1 == LEVELS) {
+                auto* leaf = static_cast<Leaf*>(inner->children[j].get());
+                for(uint64_t& word: leaf->bits) {
+                    size_t pop = std::popcount(word);
+                    if(i >= pop) {
+                        i -= pop;
+                        continue;
+                    }
+                    uint64_t w = word;
+                    for(; i > 0; --i) { w &= w - 1; }
+                    word &= ~(uint64_t{1} << std::countr_zero(w));
+                    return;
+                }
+                assert(false);
+            }
+            inner = static_cast<Inner*>(inner->children[j].get());
+        }
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        gather(&root, 0, 0, vals);
+        return vals;
+    }
+    /**
+     * @brief the number of bytes the trie occupies, including the trie object
+     *        itself but not allocator overhead
+     */
+    size_t bytes_used() const { return bytes_used(&root, 0); }
+    ~BitwiseTrieSequence() override = default;
+};
+
+/**
+ * @brief a log-structured merge sequence of integers
+ * @details inserts go into a small sorted buffer. When the buffer fills it is
+ *          merged into a list of sorted runs like a binary counter, each level
+ *          holding a run about twice the size of the one below, so every value
+ *          is merged O(log n) times. Removing a value that is not in the
+ *          buffer records a sorted tombstone instead of shifting a run, and
+ *          tombstones are dropped whenever their runs are merged. Once there
+ *          are more than about sqrt(n) tombstones, everything is compacted
+ *          into one run. The ith live value is found by a binary search over
+ *          values, counting the live values at or below each candidate with a
+ *          binary search in every run. Values must be distinct
+ *
+ * @tparam BUFFER_SIZE the number of inserts buffered before a merge
+ */
+template<size_t BUFFER_SIZE = 256>
+class LsmSequence final : public IntegerSequence {
+private:
+    static_assert(BUFFER_SIZE >= 1);
+
+    std::vector<int> buffer;
+    // levels[k] is empty or one sorted run
+    std::vector<std::vector<int>> levels;
+    // sorted values that are in some run but have been removed
+    std::vector<int> tombstones;
+    size_t count = 0;
+
+    /** remove from run, and from tombstones, the values in both */
+    void drop_tombstones(std::vector<int>& run)
+    {
+        if(tombstones.empty()) { return; }
+        std::vector<int> dead;
+        std::set_intersection(run.begin(), run.end(), tombstones.begin(),
+                              tombstones.end(), std::back_inserter(dead));
+        if(dead.empty()) { return; }
+        auto without_dead = [&dead](std::vector<int>& from) {
+            std::vector<int> kept;
+            kept.reserve(from.size() - dead.size());
+            std::set_difference(from.begin(), from.end(), dead.begin(),
+                                dead.end(), std::back_inserter(kept));
+            from = std::move(kept);
+        };
+        without_dead(run);
+        without_dead(tombstones);
+    }
+
+    /** merge run into the levels, carrying upward like a binary counter */
+    void push_run(std::vector<int> run)
+    {
+        for(auto& level: levels) {
+            if(level.empty()) {
+                drop_tombstones(run);
+                level = std::move(run);
+                return;
+            }
+            std::vector<int> merged;
+            merged.reserve(level.size() + run.size());
+            std::merge(level.begin(), level.end(), run.begin(), run.end(),
+                       std::back_inserter(merged));
+            level.clear();
+            run = std::move(merged);
+        }
+        drop_tombstones(run);
+        levels.push_back(std::move(run));
+    }
+
+    /** merge every run, and the buffer, into one run without tombstones */
+    void compact()
+    {
+        std::vector<int> all = std::move(buffer);
+        buffer.clear();
+        for(auto& level: levels) {
+            std::vector<int> merged;
+            merged.reserve(all.size() + level.size());
+            std::merge(all.begin(), all.end(), level.begin(), level.end(),
+                       std::back_inserter(merged));
+            all = std::move(merged);
+        }
+        drop_tombstones(all);
+        assert(tombstones.empty() && all.size() == count);
+        levels.assign(std::bit_width(all.size() / BUFFER_SIZE) + 1, {});
+        levels.back() = std::move(all);
+    }
+
+    /** the number of live values at or below n */
+    size_t count_at_most(int n) const
+    {
+        auto at_most = [n](const std::vector<int>& run) {
+            return static_cast<size_t>(
+                std::upper_bound(run.begin(), run.end(), n) - run.begin());
+        };
+        size_t total = at_most(buffer);
+        for(const auto& level: levels) { total += at_most(level); }
+        return total - at_most(tombstones);
+    }
+public:
+    LsmSequence() = default;
+    void insert_numerical(int n) override
+    {
+        ++count;
+        auto dead = std::lower_bound(tombstones.begin(), tombstones.end(), n);
+        if(dead != tombstones.end() && *dead == n) {
+            // it is still in its run, so just bring it back
+            tombstones.erase(dead);
+            return;
+        }
+        buffer.insert(std::lower_bound(buffer.begin(), buffer.end(), n), n);
+        if(buffer.size() < BUFFER_SIZE) { return; }
+        push_run(std::move(buffer));
+        buffer.clear();
+        buffer.reserve(BUFFER_SIZE);
+    }
+    void push_back(int n) override
+    {
+        assert(count_at_most(n) == count);
+        insert_numerical(n);
+    }
+    void push_front(int n) override
+    {
+        assert(count_at_most(n) == 0);
+        insert_numerical(n);
+    }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        // the smallest value with more than i live values at or below it
+        long long lo = INT_MIN;
+        long long hi = INT_MAX;
+        while(lo < hi) {
+            long long mid = lo + (hi - lo) / 2;
+            if(count_at_most(static_cast<int>(mid)) > i) { hi = mid; }
+            else {
+                lo = mid + 1;
+            }
+        }
+        int n = static_cast<int>(lo);
+        --count;
+
+        auto it = std::lower_bound(buffer.begin(), buffer.end(), n);
+        if(it != buffer.end() && *it == n) {
+            buffer.erase(it);
+            return;
+        }
+        tombstones.insert(
+            std::lower_bound(tombstones.begin(), tombstones.end(), n), n);
+        if(tombstones.size() * tombstones.size() > count + BUFFER_SIZE) {
+            compact();
+        }
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> all = buffer;
+        for(const auto& level: levels) {
+            std::vector<int> merged;
+            merged.reserve(all.size() + level.size());
+            std::merge(all.begin(), all.end(), level.begin(), level.end(),
+                       std::back_inserter(merged));
+            all = std::move(merged);
+        }
+        std::vector<int> vals;
+        vals.reserve(count);
+        std::set_difference(all.begin(), all.end(), tombstones.begin(),
+                            tombstones.end(), std::back_inserter(vals));
+        return vals;
+    }
+    ~LsmSequence() override = default;
+};
+
+/**
+ * @brief a sorted vector of integers with tombstones
+ * @details removing an element only clears its bit in a liveness bitmap, so
+ *          the remove phase shifts nothing. The ith live element is found by
+ *          a descent through a Fenwick tree over per-block live counts and
+ *          then popcounting the words of one block. Dead slots keep their
+ *          values, so the slots stay sorted, and an insert shifts the values
+ *          between its position and the nearest dead slot into that slot
+ *          rather than shifting the whole tail. Once more than half of the
+ *          slots are dead, the live values are compacted to the front in one
+ *          pass
+ *
+ * @tparam BLOCK_SIZE the number of slots per live count, a multiple of 64
+ */
+template<size_t BLOCK_SIZE = 512>
+class TombstoneVectorSequence final : public IntegerSequence {
+private:
+    static_assert(BLOCK_SIZE > 0 && BLOCK_SIZE % 64 == 0);
+    static constexpr size_t WORDS_PER_BLOCK = BLOCK_SIZE / 64;
+
+    // sorted, including the dead values
+    std::vector<int> vals;
+    // bit j of alive[k] is set if vals[64 * k + j] is live
+    std::vector<uint64_t> alive;
+    // the number of live slots in each block
+    utils::FenwickTree live;
+    size_t dead = 0;
+
+    /** drop the dead values, leaving every slot live */
+    void compact()
+    {
+        size_t kept = 0;
+        for(size_t j = 0; j < vals.size(); ++j) {
+            if(alive[j / 64] >> (j % 64) & 1) { vals[kept++] = vals[j]; }
+        }
+        vals.resize(kept);
+        dead = 0;
+        alive.assign((kept + 63) / 64, ~uint64_t{0});
+        if(kept % 64) { alive.back() = (uint64_t{1} << (kept % 64)) - 1; }
+
+        std::vector<size_t> blocks((kept + BLOCK_SIZE - 1) / BLOCK_SIZE,
+                                   BLOCK_SIZE);
+        if(kept % BLOCK_SIZE) { blocks.back() = kept % BLOCK_SIZE; }
+        live.assign(blocks);
+    }
+
+    /** the first dead slot at or after j, vals.size() if there is none */
+    size_t next_dead(size_t j) const
+    {
+        for(size_t k = j / 64; k < alive.size(); ++k) {
+            uint64_t free = ~alive[k];
+            if(k == j / 64) { free &= ~uint64_t{0} << (j % 64); }
+            if(free) {
+                return std::min(64 * k + std::countr_zero(free), vals.size());
+            }
+        }
+        return vals.size();
+    }
+
+    /** the last dead slot before j, SIZE_MAX if there is none */
+    size_t prev_dead(size_t j) const
+    {
+        if(j == 0) { return SIZE_MAX; }
+        size_t last = j - 1;
+        for(size_t k = last / 64 + 1; k-- > 0;) {
+            uint64_t free = ~alive[k];
+            if(k == last / 64) { free &= ~uint64_t{0} >> (63 - last % 64); }
+            if(free) { return 64 * k + 63 - std::countl_zero(free); }
+        }
+        return SIZE_MAX;
+    }
+
+    /** insert n at slot pos, reusing the nearest dead slot if there is one */
+    void insert_at(size_t pos, int n)
+    {
+        if(dead == 0) {
+            vals.insert(vals.begin() + pos, n);
+            // every slot is live, so the bitmap only grows by one set bit
+            size_t last = vals.size() - 1;
+            if(last % 64 == 0) { alive.push_back(0); }
+            alive.back() |= uint64_t{1} << (last % 64);
+            if(last % BLOCK_SIZE == 0) { live.push_back(); }
+            live.add(last / BLOCK_SIZE, 1);
+            return;
+        }
+
+        // every slot strictly between pos and the nearest dead slot is live,
+        // so shifting them into it only changes the bit of that slot
+        size_t right = next_dead(pos);
+        size_t left = prev_dead(pos);
+        size_t d;
+        if(left == SIZE_MAX
+           || (right < vals.size() && right - pos <= pos - 1 - left)) {
+            d = right;
+            std::copy_backward(vals.begin() + pos, vals.begin() + d,
+                               vals.begin() + d + 1);
+            vals[pos] = n;
+        }
+        else {
+            d = left;
+            std::copy(vals.begin() + d + 1, vals.begin() + pos,
+                      vals.begin() + d);
+            vals[pos - 1] = n;
+        }
+        alive[d / 64] |= uint64_t{1} << (d % 64);
+        live.add(d / BLOCK_SIZE, 1);
+        --dead;
+    }
+public:
+    TombstoneVectorSequence() = default;
+    void insert_numerical(int n) override
+    {
+        insert_at(std::lower_bound(vals.begin(), vals.end(), n) - vals.begin(),
+                  n);
+    }
+    void push_back(int n) override { insert_at(vals.size(), n); }
+    void push_front(int n) override { insert_at(0, n); }
+    void remove(size_t i) override
+    {
+        assert(i < size());
+        size_t b = live.find(i);
+        live.add(b, -1);
+
+        size_t k = b * WORDS_PER_BLOCK;
+        for(size_t pop; i >= (pop = std::popcount(alive[k])); ++k) {
+            i -= pop;
+        }
+        uint64_t w = alive[k];
+        for(; i > 0; --i) { w &= w - 1; }
+        alive[k] &= ~(uint64_t{1} << std::countr_zero(w));
+
+        if(2 * ++dead > vals.size()) { compact(); }
+    }
+    size_t size() override { return vals.size() - dead; }
+    bool empty() override { return size() == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> kept;
+        kept.reserve(vals.size() - dead);
+        for(size_t j = 0; j < vals.size(); ++j) {
+            if(alive[j / 64] >> (j % 64) & 1) { kept.push_back(vals[j]); }
+        }
+        return kept;
+    }
+    ~TombstoneVectorSequence() override = default;
+};
+
+/**
+ * @brief time spent in each phase of an #EytzingerVectorSequence
+ */
+struct EytzingerPhaseTimes {
+    /** finding insert positions */
+    std::chrono::nanoseconds search{0};
+    /** shifting the vector to insert and remove */
+    std::chrono::nanoseconds shift{0};
+    /** rebuilding the search index */
+    std::chrono::nanoseconds rebuild{0};
+};
+
+/**
+ * @brief a sorted vector of integers with an Eytzinger search index
+ * @details a copy of the values in Eytzinger (breadth-first) order, whose top
+ *          levels share a few cache lines, finds insert positions with a
+ *          branchless descent rather than a linear scan, so what is left of
+ *          an insert is the memmove. The index is rebuilt lazily: after d
+ *          edits an indexed rank is at most d away from the true one, so the
+ *          descent is followed by a binary search over that window. The
+ *          index is rebuilt, in one pass, by the first search after d passes
+ *          about sqrt(n), so edits only count and removals, which never
+ *          search, never pay for a rebuild
+ *
+ * @tparam PROFILE whether to time each phase into phase_times(). Off for the
+ *         comparisons, since reading the clock costs about as much as a
+ *         search
+ */
+template<bool PROFILE = false>
+class EytzingerVectorSequence final : public IntegerSequence {
+private:
+    static constexpr size_t MIN_DRIFT = 64;
+
+    std::vector<int> vals;
+    // 1-based Eytzinger layout of the values when the index was built
+    std::vector<int> tree = std::vector<int>(1);
+    // ranks[k] is the rank of tree[k] among those values
+    std::vector<size_t> ranks = std::vector<size_t>(1);
+    // the number of edits since the index was built
+    size_t drift = 0;
+    EytzingerPhaseTimes phases;
+
+    /** the time, if PROFILE, so that a plain build never reads the clock */
+    static std::chrono::high_resolution_clock::time_point now()
+    {
+        if constexpr(PROFILE) {
+            return std::chrono::high_resolution_clock::now();
+        }
+        return {};
+    }
+
+    /** rebuild the index if it has drifted too far */
+    void reindex_if_drifted()
+    {
+        if(drift * drift <= vals.size() + MIN_DRIFT * MIN_DRIFT) { return; }
+        auto start = now();
+        size_t n = vals.size();
+        tree.resize(n + 1);
+        ranks.resize(n + 1);
+        // visit the nodes in order, starting from the leftmost: the next node
+        // is the leftmost of the right subtree if there is one, and otherwise
+        // the nearest ancestor whose left subtree this one is in
+        size_t k = 1;
+        while(2 * k <= n) { k *= 2; }
+        for(size_t r = 0; r < n; ++r) {
+            tree[k] = vals[r];
+            ranks[k] = r;
+            if(2 * k + 1 <= n) {
+                for(k = 2 * k + 1; 2 * k <= n;) { k *= 2; }
+            }
+            else {
+                k >>= std::countr_one(k) + 1;
+            }
+        }
+        drift = 0;
+        if constexpr(PROFILE) {
+            phases.rebuild += now() - start;
+        }
+    }
+
+    /** the index of the first value not less than n */
+    size_t search(int n)
+    {
+        reindex_if_drifted();
+        auto start = now();
+        size_t k = 1;
+        while(k < tree.size()) { k = 2 * k + (tree[k] < n); }
+        k >>= std::countr_one(k) + 1;
+        // k == 0 means every indexed value is less than n
+        size_t r = k == 0 ? tree.size() - 1 : ranks[k];
+
+        size_t lo = r > drift ? r - drift : 0;
+        size_t hi = std::min(r + drift, vals.size());
+        size_t pos = std::lower_bound(vals.begin() + lo, vals.begin() + hi, n)
+                     - vals.begin();
+        if constexpr(PROFILE) {
+            phases.search += now() - start;
+        }
+        return pos;
+    }
+
+    void insert_at(size_t pos, int n)
+    {
+        auto start = now();
+        vals.insert(vals.begin() + pos, n);
+        if constexpr(PROFILE) {
+            phases.shift += now() - start;
+        }
+        ++drift;
+    }
+public:
+    EytzingerVectorSequence() = default;
+    void insert_numerical(int n) override { insert_at(search(n), n); }
+    void push_back(int n) override { insert_at(vals.size(), n); }
+    void push_front(int n) override { insert_at(0, n); }
+    void remove(size_t i) override
+    {
+        assert(i < vals.size());
+        auto start = now();
+        vals.erase(vals.begin() + i);
+        if constexpr(PROFILE) {
+            phases.shift += now() - start;
+        }
+        ++drift;
+    }
+    size_t size() override { return vals.size(); }
+    bool empty() override { return vals.empty(); }
+    std::vector<int> to_vector() const override { return vals; }
+    /**
+     * @brief the time spent in each phase so far, if PROFILE
+     */
+    const EytzingerPhaseTimes& phase_times() const { return phases; }
+    ~EytzingerVectorSequence() override = default;
+};
+
+/**
+ * @brief a list of integers that remembers where the last edit happened
+ * @details keeps a cursor (an iterator and its index) at the last edit, and
+ *          reaches position i by walking from whichever of the head, the tail
+ *          and the cursor is nearest. insert_numerical walks from the cursor
+ *          toward n unless n belongs at either end. Edits that land near the
+ *          previous one therefore cost O(distance) rather than O(n)
+ */
+class FingerListSequence final : public IntegerSequence {
+private:
+    std::list<int> l;
+    // cursor_index is the index of cursor, l.size() when it is l.end()
+    std::list<int>::iterator cursor = l.end();
+    size_t cursor_index = 0;
+
+    /** the iterator at index i, by the shortest walk */
+    std::list<int>::iterator seek(size_t i)
+    {
+        size_t from_cursor = i > cursor_index ? i - cursor_index
+                                              : cursor_index - i;
+        std::list<int>::iterator it;
+        if(i <= from_cursor && i <= l.size() - i) {
+            it = l.begin();
+            for(size_t j = 0; j < i; ++j) { ++it; }
+        }
+        else if(l.size() - i <= from_cursor) {
+            it = l.end();
+            for(size_t j = l.size(); j > i; --j) { --it; }
+        }
+        else {
+            it = cursor;
+            for(size_t j = cursor_index; j < i; ++j) { ++it; }
+            for(size_t j = cursor_index; j > i; --j) { --it; }
+        }
+        return it;
+    }
+public:
+    FingerListSequence() = default;
+    FingerListSequence(const FingerListSequence&) = delete;
+    FingerListSequence& operator=(const FingerListSequence&) = delete;
+    void insert_numerical(int n) override
+    {
+        if(l.empty() || n <= l.front()) {
+            push_front(n);
+            return;
+        }
+        if(n > l.back()) {
+            push_back(n);
+            return;
+        }
+        // front < n <= back, so the position is strictly inside the list
+        if(cursor == l.end()) {
+            --cursor;
+            --cursor_index;
+        }
+        if(*cursor < n) {
+            while(*cursor < n) {
+                ++cursor;
+                ++cursor_index;
+            }
+        }
+        else {
+            while(*std::prev(cursor) >= n) {
+                --cursor;
+                --cursor_index;
+            }
+        }
+        cursor = l.insert(cursor, n);
+    }
+    void push_back(int n) override
+    {
+        l.push_back(n);
+        cursor = std::prev(l.end());
+        cursor_index = l.size() - 1;
+    }
+    void push_front(int n) override
+    {
+        l.push_front(n);
+        cursor = l.begin();
+        cursor_index = 0;
+    }
+    void remove(size_t i) override
+    {
+        assert(i < l.size());
+        cursor = l.erase(seek(i));
+        cursor_index = i;
+    }
+    size_t size() override { return l.size(); }
+    bool empty() override { return l.empty(); }
+    std::vector<int> to_vector() const override { return {l.begin(), l.end()}; }
+    ~FingerListSequence() override = default;
+};
+
+/**
+ * @brief a linked list of integers whose nodes live in one vector
+ * @details the same walks as ListAdaptor, but the nodes are kept densely in a
+ *          std::vector and linked by 32-bit indices, with freed nodes reused
+ *          through a free list. A node is 12 bytes rather than the 24 of a
+ *          std::list node plus malloc's header, and no edit allocates once
+ *          the vector has grown, so the difference between this and
+ *          ListAdaptor is the cost of allocation and scattered nodes
+ */
+class IndexListSequence final : public IntegerSequence {
+private:
+    struct Node {
+        int val = 0;
+        uint32_t next = 0;
+        uint32_t prev = 0;
+    };
+
+    // nodes[HEAD] is a sentinel, so the list is circular through it
+    static constexpr uint32_t HEAD = 0;
+    std::vector<Node> nodes = std::vector<Node>(1);
+    // a chain through next of unused nodes, HEAD if there are none
+    uint32_t free_list = HEAD;
+    size_t count = 0;
+
+    /** link a node holding n in before node at */
+    void insert_before(uint32_t at, int n)
+    {
+        uint32_t node = free_list;
+        if(node != HEAD) { free_list = nodes[node].next; }
+        else {
+            assert(nodes.size() < UINT32_MAX);
+            node = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        uint32_t prev = nodes[at].prev;
+        nodes[node] = {n, at, prev};
+        nodes[prev].next = node;
+        nodes[at].prev = node;
+        ++count;
+    }
+public:
+    IndexListSequence() = default;
+    void insert_numerical(int n) override
+    {
+        uint32_t at = nodes[HEAD].next;
+        while(at != HEAD && nodes[at].val < n) { at = nodes[at].next; }
+        insert_before(at, n);
+    }
+    void push_back(int n) override { insert_before(HEAD, n); }
+    void push_front(int n) override { insert_before(nodes[HEAD].next, n); }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        uint32_t at = nodes[HEAD].next;
+        for(size_t j = 0; j < i; ++j) { at = nodes[at].next; }
+        nodes[nodes[at].prev].next = nodes[at].next;
+        nodes[nodes[at].next].prev = nodes[at].prev;
+        nodes[at].next = free_list;
+        free_list = at;
+        --count;
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(uint32_t at = nodes[HEAD].next; at != HEAD; at = nodes[at].next) {
+            vals.push_back(nodes[at].val);
+        }
+        return vals;
+    }
+    ~IndexListSequence() override = default;
+};
+
+/**
+ * @brief a list of integers that can re-lay its nodes in traversal order
+ * @details the same walks as ListAdaptor, but the nodes are allocated from a
+ *          std::pmr::monotonic_buffer_resource. defragment copies the list
+ *          into a fresh resource in traversal order, so neighbours become
+ *          adjacent in memory, and drops the old one. Every size() edits the
+ *          fragmentation is measured, and the list is defragmented if it is
+ *          over MAX_DISTANCE, which keeps the O(n) checks and relayouts
+ *          amortized O(1) per edit
+ *
+ * @tparam MAX_DISTANCE the mean neighbour distance, in bytes, above which to
+ *         defragment
+ */
+template<size_t MAX_DISTANCE = 256>
+class DefragListSequence final : public IntegerSequence {
+private:
+    using List = std::pmr::list<int>;
+
+    // declared before l, so that it outlives the nodes in it
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> resource
+        = std::make_unique<std::pmr::monotonic_buffer_resource>();
+    std::unique_ptr<List> l = std::make_unique<List>(resource.get());
+    size_t edits = 0;
+
+    /** count an edit, and defragment if it is time to and needed */
+    void edited()
+    {
+        if(++edits < std::max<size_t>(l->size(), 64)) { return; }
+        edits = 0;
+        if(fragmentation() > MAX_DISTANCE) { defragment(); }
+    }
+public:
+    DefragListSequence() = default;
+    void insert_numerical(int n) override
+    {
+        utils::insert_in_numerical_order(*l, n);
+        edited();
+    }
+    void push_back(int n) override
+    {
+        l->push_back(n);
+        edited();
+    }
+    void push_front(int n) override
+    {
+        l->push_front(n);
+        edited();
+    }
+    void remove(size_t i) override
+    {
+        auto it = l->begin();
+        for(size_t j = 0; j < i; ++j) { ++it; }
+        l->erase(it);
+        edited();
+    }
+    size_t size() override { return l->size(); }
+    bool empty() override { return l->empty(); }
+    std::vector<int> to_vector() const override
+    {
+        return {l->begin(), l->end()};
+    }
+    /**
+     * @brief how scattered the nodes are
+     *
+     * @see utils::mean_neighbour_distance
+     */
+    double fragmentation() const { return utils::mean_neighbour_distance(*l); }
+    /**
+     * @brief re-lay the nodes contiguously in traversal order
+     */
+    void defragment()
+    {
+        auto fresh = std::make_unique<std::pmr::monotonic_buffer_resource>(
+            l->size() * LIST_NODE_BYTES + 64);
+        auto relaid = std::make_unique<List>(l->begin(), l->end(), fresh.get());
+        l = std::move(relaid);
+        resource = std::move(fresh);
+    }
+    ~DefragListSequence() override = default;
+};
+
+/**
+ * @brief a list of integers that prefetches ahead of its walks
+ * @details a circular doubly linked list through a sentinel, in which every
+ *          node also has a jump pointer to the node PREFETCH_DISTANCE ahead,
+ *          so a walk can prefetch that node while it follows next. An edit
+ *          repairs the jump pointers of the PREFETCH_DISTANCE nodes before it,
+ *          which the walk has just brought into cache. On top of the list, a
+ *          skip index records the first node, its value and the size of every
+ *          run of about SEGMENT nodes, so a walk starts from the right run
+ *          rather than from the head and is at most 2 * SEGMENT nodes long
+ *
+ * @tparam PREFETCH_DISTANCE how many nodes ahead to prefetch, 0 for none
+ * @tparam SEGMENT the number of nodes per skip index entry
+ */
+template<size_t PREFETCH_DISTANCE = 8, size_t SEGMENT = 64>
+class PrefetchListSequence final : public IntegerSequence {
+private:
+    static_assert(SEGMENT >= 1);
+
+    struct Node {
+        int val = 0;
+        Node* next = this;
+        Node* prev = this;
+        Node* jump = this;
+    };
+
+    Node head;
+    size_t count = 0;
+    // segments[j] starts at firsts[j], whose value is first_vals[j]
+    std::vector<Node*> firsts;
+    std::vector<int> first_vals;
+    std::vector<size_t> sizes;
+
+    static Node* step(Node* node)
+    {
+        if constexpr(PREFETCH_DISTANCE > 0) { __builtin_prefetch(node->jump); }
+        return node->next;
+    }
+
+    /** set every jump pointer from scratch, for lists shorter than the jump */
+    void reset_jumps()
+    {
+        size_t ring = count + 1;
+        Node* node = &head;
+        for(size_t k = 0; k < ring; ++k, node = node->next) {
+            node->jump = node;
+            for(size_t d = 0; d < PREFETCH_DISTANCE % ring; ++d) {
+                node->jump = node->jump->next;
+            }
+        }
+    }
+
+    /** link node in before at, in segment j */
+    void link_before(Node* at, Node* node, size_t j)
+    {
+        Node* prev = at->prev;
+        node->next = at;
+        node->prev = prev;
+        prev->next = node;
+        at->prev = node;
+        ++count;
+
+        if constexpr(PREFETCH_DISTANCE > 0) {
+            if(PREFETCH_DISTANCE + 2 > count + 1) { reset_jumps(); }
+            else {
+                // node takes over prev's old jump, and each of the nodes
+                // before it now jumps one node shorter
+                node->jump = prev->jump;
+                Node* p = prev;
+                for(size_t d = 0; d < PREFETCH_DISTANCE; ++d, p = p->prev) {
+                    p->jump = p->jump->prev;
+                }
+            }
+        }
+
+        ++sizes[j];
+        if(sizes[j] <= 2 * SEGMENT) { return; }
+        Node* mid = firsts[j];
+        for(size_t k = 0; k < SEGMENT; ++k) { mid = mid->next; }
+        firsts.insert(firsts.begin() + j + 1, mid);
+        first_vals.insert(first_vals.begin() + j + 1, mid->val);
+        sizes.insert(sizes.begin() + j + 1, sizes[j] - SEGMENT);
+        sizes[j] = SEGMENT;
+    }
+
+    /** insert n before at, as the first node of segment j if first */
+    void insert_before(Node* at, int n, size_t j, bool first)
+    {
+        auto* node = new Node;
+        node->val = n;
+        if(firsts.empty()) {
+            firsts.push_back(node);
+            first_vals.push_back(n);
+            sizes.push_back(0);
+        }
+        else if(first) {
+            firsts[j] = node;
+            first_vals[j] = n;
+        }
+        link_before(at, node, j);
+    }
+public:
+    PrefetchListSequence() = default;
+    PrefetchListSequence(const PrefetchListSequence&) = delete;
+    PrefetchListSequence& operator=(const PrefetchListSequence&) = delete;
+    void insert_numerical(int n) override
+    {
+        // the last segment starting below n, if any
+        size_t j = std::lower_bound(first_vals.begin(), first_vals.end(), n)
+                   - first_vals.begin();
+        if(j == 0) {
+            insert_before(head.next, n, 0, true);
+            return;
+        }
+        --j;
+        Node* at = firsts[j];
+        while(at != &head && at->val < n) { at = step(at); }
+        insert_before(at, n, j, false);
+    }
+    void push_back(int n) override
+    {
+        insert_before(&head, n, sizes.empty() ? 0 : sizes.size() - 1, false);
+    }
+    void push_front(int n) override { insert_before(head.next, n, 0, true); }
+    void remove(size_t i) override
+    {
+        assert(i < count);
+        size_t j = 0;
+        while(i >= sizes[j]) { i -= sizes[j++]; }
+        Node* node = firsts[j];
+        for(; i > 0; --i) { node = step(node); }
+
+        if(--sizes[j] == 0) {
+            firsts.erase(firsts.begin() + j);
+            first_vals.erase(first_vals.begin() + j);
+            sizes.erase(sizes.begin() + j);
+        }
+        else if(node == firsts[j]) {
+            firsts[j] = node->next;
+            first_vals[j] = node->next->val;
+        }
+
+        if constexpr(PREFETCH_DISTANCE > 0) {
+            if(PREFETCH_DISTANCE + 2 <= count) {
+                // each of the nodes before node now jumps one node further
+                Node* p = node->prev;
+                for(size_t d = 0; d < PREFETCH_DISTANCE; ++d, p = p->prev) {
+                    p->jump = p->jump->next;
+                }
+            }
+        }
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        delete node;
+        --count;
+        if constexpr(PREFETCH_DISTANCE > 0) {
+            if(PREFETCH_DISTANCE + 2 > count + 1) { reset_jumps(); }
+        }
+    }
+    size_t size() override { return count; }
+    bool empty() override { return count == 0; }
+    std::vector<int> to_vector() const override
+    {
+        std::vector<int> vals;
+        vals.reserve(count);
+        for(const Node* node = head.next; node != &head; node = node->next) {
+            vals.push_back(node->val);
+        }
+        return vals;
+    }
+    ~PrefetchListSequence() override
+    {
+        for(Node* node = head.next; node != &head;) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+};
+
+/**
+ * @brief a sequence of integers that switches representation with its size
+ * @details a plain vector, with VectorAdaptor's linear insertion, until it
+ *          holds more than threshold values, and then a TieredVectorSequence.
+ *          It goes back to a vector once it shrinks below threshold / 2, so a
+ *          size hovering around the threshold does not migrate on every edit.
+ *          Each migration is O(n), and happens at most once per threshold / 2
+ *          edits
+ */
+class HybridSequence final : public IntegerSequence {
+private:
+    size_t threshold;
+    std::vector<int> small;
+    // null while the values are in small
+    std::unique_ptr<TieredVectorSequence<>> large;
+
+    /** migrate to whichever representation suits the size */
+    void migrate()
+    {
+        if(!large && small.size() > threshold) {
+            large = std::make_unique<TieredVectorSequence<>>();
+            for(int n: small) { large->push_back(n); }
+            small = {};
+        }
+        else if(large && large->size() < threshold / 2) {
+            small = large->to_vector();
+            large.reset();
+        }
+    }
+public:
+    /**
+     * @param threshold the size above which to use a TieredVectorSequence
+     */
+    explicit HybridSequence(size_t threshold): threshold(threshold) {}
+    void insert_numerical(int n) override
+    {
+        if(large) { large->insert_numerical(n); }
+        else {
+            utils::insert_in_numerical_order(small, n);
+        }
+        migrate();
+    }
+    void push_back(int n) override
+    {
+        if(large) { large->push_back(n); }
+        else {
+            small.push_back(n);
+        }
+        migrate();
+    }
+    void push_front(int n) override
+    {
+        if(large) { large->push_front(n); }
+        else {
+            small.insert(small.begin(), n);
+        }
+        migrate();
+    }
+    void remove(size_t i) override
+    {
+        if(large) { large->remove(i); }
+        else {
+            small.erase(small.begin() + i);
+        }
+        migrate();
+    }
+    size_t size() override { return large ? large->size() : small.size(); }
+    bool empty() override { return size() == 0; }
+    std::vector<int> to_vector() const override
+    {
+        return large ? large->to_vector() : small;
+    }
+    ~HybridSequence() override = default;
+};
+
+/**
+ * @brief a sequence of integers stored inline, up to CAPACITY of them
+ * @details the values live in an array inside the object, so a small sequence
+ *          never allocates. Past CAPACITY they spill to a std::vector, and
+ *          they come back inline once the sequence shrinks to CAPACITY / 2.
+ *          Insertion is VectorAdaptor's linear scan. Every operation is
+ *          constexpr
+ *
+ * @tparam CAPACITY the number of values stored inline
+ */
+template<size_t CAPACITY = 64>
+class InplaceSequence final : public IntegerSequence {
+private:
+    static_assert(CAPACITY >= 1);
+
+    std::array<int, CAPACITY> inline_vals{};
+    size_t count = 0;
+    // holds the values instead of inline_vals once they have spilled
+    std::vector<int> heap;
+    bool spilled = false;
+
+    constexpr int* data() { return spilled ? heap.data() : inline_vals.data(); }
+
+    constexpr void insert_at(size_t pos, int n)
+    {
+        if(spilled) {
+            heap.insert(heap.begin() + pos, n);
+            ++count;
+            return;
+        }
+        if(count == CAPACITY) {
+            heap.reserve(2 * CAPACITY);
+            heap.assign(inline_vals.begin(), inline_vals.end());
+            spilled = true;
+            insert_at(pos, n);
+            return;
+        }
+        std::copy_backward(inline_vals.begin() + pos,
+                           inline_vals.begin() + count,
+                           inline_vals.begin() + count + 1);
+        inline_vals[pos] = n;
+        ++count;
+    }
+public:
+    constexpr InplaceSequence() = default;
+    constexpr void insert_numerical(int n) override
+    {
+        const int* vals = data();
+        size_t pos = 0;
+        while(pos < count && vals[pos] < n) { ++pos; }
+        insert_at(pos, n);
+    }
+    constexpr void push_back(int n) override { insert_at(count, n); }
+    constexpr void push_front(int n) override { insert_at(0, n); }
+    constexpr void remove(size_t i) override
+    {
+        assert(i < count);
+        int* vals = data();
+        std::copy(vals + i + 1, vals + count, vals + i);
+        --count;
+        if(spilled && count <= CAPACITY / 2) {
+            std::copy(heap.begin(), heap.begin() + count,
+                      inline_vals.begin());
+            heap = {};
+            spilled = false;
+        }
+        else if(spilled) {
+            heap.pop_back();
+        }
+    }
+    constexpr size_t size() override { return count; }
+    constexpr bool empty() override { return count == 0; }
+    constexpr std::vector<int> to_vector() const override
+    {
+        const int* vals = spilled ? heap.data() : inline_vals.data();
+        return {vals, vals + count};
+    }
+    constexpr ~InplaceSequence() override = default;
 };
 
 #endif // LVV_H
@@ -25,6 +25,11 @@ def plot_csv_functions(filename):
     plt.plot(df['x'], df['rolling_avg_listtime'], label=f'{window_size}-Rolling Avg of std::list time', linestyle='--', color = 'orange')
     plt.plot(df['x'], df['rolling_avg_vecgain'], label=f'{window_size}-Rolling Avg of Speedup', linestyle='--', color = 'green')
 
+    # any other sequences under test get a time column named <name>time
+    other_columns = [col for col in df.columns if col.endswith('time') and col not in required_columns]
+    for column in other_columns:
+        plt.plot(df['x'], df[column], label=f'{column[:-len("time")]} time')
+
     plt.xlabel('Number of Elements')
     plt.ylabel('Time (ns)')
     plt.title('List vs. Vector Performance Comparison')